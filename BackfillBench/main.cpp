@@ -0,0 +1,237 @@
+#include <bits/stdc++.h>
+
+#include "../Logger.h"
+#include "../MarketDataClient/OHLCBarAggregator.h"
+
+using namespace std;
+using namespace Logger;
+namespace fs = filesystem;
+
+// Backfill benchmark and equivalence check for OHLCBarAggregator. Replays
+// the same synthetic tick stream through the scalar path (onPrice(Tick), one
+// tick at a time) and the batch path (onPrices), both in EventTime mode,
+// compares the bar files byte for byte and reports the speedup:
+//
+//   BackfillBench [ticks] [symbols] [batch size] [max spacing ms]
+//
+// Ticks are 0 to <max spacing> ms apart (default 40, i.e. about 2.5 ticks
+// per symbol per second with 20 symbols); sparser streams close more bars
+// per tick, and bar output costs the same on both paths.
+// Two configurations run: the default timeframe set (compile-time kernel)
+// and a custom set with empty bars enabled (runtime periods). A per-file
+// replay (symbol A, then B from an earlier time, then A again) checks that
+// bars whose bucket the bar clock has already passed are still written. The
+// exit code is 1 if any output differs or a replayed bar is missing.
+
+struct Config {
+  string name;
+  vector<Timeframe> timeframes;
+  bool emitEmptyBars;
+};
+
+// Deterministic stream: random symbol, random walk in increments, random
+// spacing, with an occasional quiet gap of up to 10 minutes.
+vector<Tick> makeTicks(size_t count, size_t symbols, int maxSpacingMs) {
+  mt19937_64 rng(42);
+  uniform_int_distribution<size_t> pickSymbol(0, symbols - 1);
+  uniform_int_distribution<int> step(-3, 3);
+  uniform_int_distribution<long> size(1, 100);
+  uniform_int_distribution<int> spacingMs(0, maxSpacingMs);
+  uniform_int_distribution<int> gapSeconds(0, 600);
+  bernoulli_distribution quiet(0.00001);
+
+  vector<string> names;
+  vector<FixedPrice> prices;
+  for (size_t i = 0; i < symbols; ++i) {
+    names.push_back("SYM" + to_string(i));
+    prices.push_back(100000 + 1000 * static_cast<FixedPrice>(i));
+  }
+
+  vector<Tick> ticks(count);
+  auto ts = chrono::system_clock::from_time_t(1700000000);
+  for (auto &tick : ticks) {
+    ts += chrono::milliseconds(spacingMs(rng));
+    if (quiet(rng))
+      ts += chrono::seconds(gapSeconds(rng));
+    size_t s = pickSymbol(rng);
+    prices[s] = max<FixedPrice>(1, prices[s] + step(rng));
+    tick.symbol = names[s];
+    tick.price = prices[s];
+    tick.volume = size(rng);
+    tick.timestamp = ts;
+  }
+  return ticks;
+}
+
+template <typename Feed>
+double run(const string &clientId, const Config &config, Feed feed) {
+  fs::remove_all("OHLC_price_data_" + clientId);
+  auto start = chrono::steady_clock::now();
+  {
+    OHLCBarAggregator agg(clientId, "", config.timeframes);
+    agg.setBarClose(BarCloseMode::EventTime, config.emitEmptyBars);
+    feed(agg);
+    agg.flushAll();
+  }
+  return chrono::duration<double>(chrono::steady_clock::now() - start)
+      .count();
+}
+
+// Number of files that differ (or exist on one side only).
+size_t compareOutputs(const fs::path &a, const fs::path &b, size_t &files) {
+  auto slurp = [](const fs::path &path) {
+    ifstream in(path, ios::binary);
+    return string(istreambuf_iterator<char>(in), {});
+  };
+  set<string> names;
+  for (const auto &dir : {a, b}) {
+    for (const auto &entry : fs::directory_iterator(dir))
+      names.insert(entry.path().filename().string());
+  }
+  size_t mismatches = 0;
+  for (const auto &name : names) {
+    if (!fs::exists(a / name) || !fs::exists(b / name) ||
+        slurp(a / name) != slurp(b / name)) {
+      error("Output differs: " + name);
+      ++mismatches;
+    }
+  }
+  files = names.size();
+  return mismatches;
+}
+
+size_t countBars(const fs::path &file) {
+  ifstream in(file);
+  size_t lines = 0;
+  string line;
+  while (getline(in, line))
+    ++lines;
+  return lines > 0 ? lines - 1 : 0; // header
+}
+
+// Replays two "files" the way a backfill reads them: A for 0..299s, B for
+// 0..99s, then A for 300..599s, one tick per second. B's bars are behind the
+// bar clock, so their timers fire late; each must still close its own bar
+// before the final flushAll() would hide the loss. Returns the number of
+// failed checks.
+size_t replayCheck() {
+  const long long base = 1700000040; // on a minute boundary
+  auto file = [base](const string &symbol, long long from, long long to) {
+    vector<Tick> ticks;
+    for (long long s = from; s < to; ++s) {
+      Tick tick;
+      tick.symbol = symbol;
+      tick.price = 100000 + s;
+      tick.volume = 1;
+      tick.timestamp = chrono::system_clock::from_time_t(base + s);
+      ticks.push_back(tick);
+    }
+    return ticks;
+  };
+  vector<vector<Tick>> inputs = {file("A", 0, 300), file("B", 0, 100),
+                                 file("A", 300, 600)};
+  // Bars on disk before the final flush (only A's last bars still open),
+  // then after it
+  struct Expected {
+    string name;
+    size_t beforeFlush, afterFlush;
+  };
+  vector<Expected> expected = {{"A_1s.csv", 599, 600},
+                               {"B_1s.csv", 100, 100},
+                               {"A_1m.csv", 9, 10},
+                               {"B_1m.csv", 2, 2}};
+
+  size_t failures = 0;
+  auto check = [&](const string &dir, bool flushed) {
+    for (const auto &e : expected) {
+      size_t want = flushed ? e.afterFlush : e.beforeFlush;
+      size_t bars = countBars(fs::path(dir) / e.name);
+      if (bars != want) {
+        error("Per-file replay: " + dir + "/" + e.name + " has " +
+              to_string(bars) + " bars " +
+              (flushed ? "after" : "before") + " flushAll, expected " +
+              to_string(want));
+        ++failures;
+      }
+    }
+  };
+  Config config{"replay", Timeframes::defaults(), false};
+  run("bench_scalar", config, [&](OHLCBarAggregator &a) {
+    for (const auto &ticks : inputs) {
+      for (const auto &tick : ticks)
+        a.onPrice(tick);
+    }
+    check("OHLC_price_data_bench_scalar", false);
+  });
+  run("bench_batch", config, [&](OHLCBarAggregator &a) {
+    for (const auto &ticks : inputs)
+      a.onPrices(ticks);
+    check("OHLC_price_data_bench_batch", false);
+  });
+  check("OHLC_price_data_bench_scalar", true);
+  check("OHLC_price_data_bench_batch", true);
+
+  size_t files = 0;
+  failures += compareOutputs("OHLC_price_data_bench_scalar",
+                             "OHLC_price_data_bench_batch", files);
+  if (failures == 0)
+    info("Per-file replay (A, B, A): " + to_string(files) +
+         " files, every bar closed on time, identical");
+  return failures;
+}
+
+int main(int argc, char **argv) {
+  try {
+    size_t tickCount = argc > 1 ? stoul(argv[1]) : 2000000;
+    size_t symbols = argc > 2 ? stoul(argv[2]) : 20;
+    size_t batchSize = argc > 3 ? stoul(argv[3]) : 100000;
+    int maxSpacingMs = argc > 4 ? stoi(argv[4]) : 40;
+    if (tickCount == 0 || symbols == 0 || batchSize == 0 || maxSpacingMs < 0)
+      throw invalid_argument("ticks, symbols and batch size must be > 0");
+
+    vector<Tick> ticks = makeTicks(tickCount, symbols, maxSpacingMs);
+    vector<vector<Tick>> chunks;
+    for (size_t i = 0; i < ticks.size(); i += batchSize) {
+      chunks.emplace_back(ticks.begin() + i,
+                          ticks.begin() + min(ticks.size(), i + batchSize));
+    }
+    vector<Config> configs = {
+        {"default timeframes", Timeframes::defaults(), false},
+        {"custom timeframes, empty bars",
+         Timeframes::parseList("2s,1m,3m,1h,1d"), true},
+    };
+
+    size_t failures = 0;
+    for (const auto &config : configs) {
+      double scalar = run("bench_scalar", config, [&](OHLCBarAggregator &a) {
+        for (const auto &tick : ticks)
+          a.onPrice(tick);
+      });
+      double batch = run("bench_batch", config, [&](OHLCBarAggregator &a) {
+        for (const auto &chunk : chunks)
+          a.onPrices(chunk);
+      });
+      size_t files = 0;
+      size_t mismatches = compareOutputs("OHLC_price_data_bench_scalar",
+                                         "OHLC_price_data_bench_batch", files);
+      failures += mismatches;
+
+      stringstream ss;
+      ss << fixed << setprecision(1) << config.name << ": " << tickCount
+         << " ticks, " << symbols << " symbols, batch " << batchSize
+         << " | scalar " << scalar * 1e9 / tickCount << " ns/tick, batch "
+         << batch * 1e9 / tickCount << " ns/tick, speedup "
+         << (batch > 0 ? scalar / batch : 0.0) << "x | " << files
+         << " files, " << (mismatches ? "MISMATCH" : "identical");
+      if (mismatches)
+        error(ss.str());
+      else
+        info(ss.str());
+    }
+    failures += replayCheck();
+    return failures == 0 ? 0 : 1;
+  } catch (exception &e) {
+    error(string("Error: ") + e.what());
+    return 1;
+  }
+}
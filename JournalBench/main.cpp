@@ -0,0 +1,95 @@
+#include <bits/stdc++.h>
+
+#include "../Logger.h"
+#include "../MarketDataClient/TickJournal.h"
+
+using namespace std;
+using namespace Logger;
+namespace fs = filesystem;
+
+// Capture cost and round-trip check for TickJournal. Appends a synthetic
+// record stream from one producer thread while the writer thread compresses
+// it, reports ns/record for append() alone and for the whole run (until the
+// writer has flushed), then reads the day back with readJournalRange and
+// compares it with what was appended:
+//
+//   JournalBench [records] [symbols] [ring capacity]
+//
+// With the default ring every record fits, so append() never drops; a
+// smaller ring shows the cost when the writer falls behind. The exit code is
+// 1 if the journal does not read back exactly the records that were kept.
+
+int main(int argc, char **argv) {
+  try {
+    size_t count = argc > 1 ? stoul(argv[1]) : 2000000;
+    size_t symbols = argc > 2 ? stoul(argv[2]) : 20;
+    size_t ringCapacity = argc > 3 ? stoul(argv[3]) : count;
+    if (count == 0 || symbols == 0 || ringCapacity == 0)
+      throw invalid_argument("records, symbols and ring must be > 0");
+
+    // Deterministic stream inside one UTC day, one record per microsecond
+    mt19937_64 rng(42);
+    uniform_int_distribution<uint32_t> pickSymbol(0, symbols - 1);
+    uniform_int_distribution<int> step(-3, 3);
+    uniform_int_distribution<int64_t> size(1, 100);
+    vector<int64_t> prices(symbols, 100000);
+    vector<JournalRecord> records(count);
+    int64_t dayStartNs = 1700006400LL * 1000000000; // 2023-11-15 00:00 UTC
+    for (size_t i = 0; i < count; ++i) {
+      JournalRecord &r = records[i];
+      r.symbolId = pickSymbol(rng);
+      r.type = static_cast<JournalTickType>(i % 3);
+      r.decimals = 5;
+      r.reserved = 0;
+      prices[r.symbolId] = max<int64_t>(1, prices[r.symbolId] + step(rng));
+      r.price = prices[r.symbolId];
+      r.size = size(rng);
+      r.receiveTimeNs = dayStartNs + static_cast<int64_t>(i) * 1000;
+      r.eventTimeNs = r.receiveTimeNs - 250000;
+    }
+
+    string dir = "tick_journal_bench";
+    fs::remove_all(dir);
+    auto journal = make_unique<TickJournal>(dir, ringCapacity);
+    auto start = chrono::steady_clock::now();
+    for (const auto &record : records)
+      journal->append(record);
+    double appendSeconds =
+        chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    // Producer-side drops are final once appending stops
+    uint64_t dropped = journal->dropped();
+    journal.reset(); // joins the writer after the last block
+    double totalSeconds =
+        chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    string path = dir + "/20231115.tj";
+    vector<JournalRecord> back =
+        readJournalRange(path, dayStartNs, numeric_limits<int64_t>::max());
+    // What was kept is a subsequence of what was appended
+    size_t matched = 0;
+    for (size_t i = 0; i < count && matched < back.size(); ++i) {
+      if (memcmp(&records[i], &back[matched], sizeof(JournalRecord)) == 0)
+        ++matched;
+    }
+    bool ok = matched == back.size() && back.size() + dropped == count;
+
+    uint64_t bytes = fs::file_size(path) + fs::file_size(dir + "/20231115.idx");
+    stringstream ss;
+    ss << fixed << setprecision(1) << count << " records, " << symbols
+       << " symbols, ring " << ringCapacity << " | append "
+       << appendSeconds * 1e9 / count << " ns/record, with writer "
+       << totalSeconds * 1e9 / count << " ns/record | " << dropped
+       << " dropped, " << bytes << " bytes on disk ("
+       << double(count * sizeof(JournalRecord)) / max<uint64_t>(bytes, 1)
+       << "x) | read back " << back.size() << ", "
+       << (ok ? "identical" : "MISMATCH");
+    if (ok)
+      info(ss.str());
+    else
+      error(ss.str());
+    return ok ? 0 : 1;
+  } catch (exception &e) {
+    error(string("Error: ") + e.what());
+    return 1;
+  }
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <bits/stdc++.h>
+#include <quickfix/SessionSettings.h>
+
+using namespace std;
+using namespace FIX;
+
+// Settings are optional, but a value that is present must parse: a typo
+// stops the client with ConfigError instead of silently using the default.
+inline long long configInt(const string &key, const string &value,
+                           long long lo, long long hi) {
+  long long v = 0;
+  const char *end = value.data() + value.size();
+  auto [ptr, ec] = from_chars(value.data(), end, v);
+  if (ec != errc() || ptr != end || v < lo || v > hi) {
+    throw ConfigError(key + "=" + value + " is not an integer in [" +
+                      to_string(lo) + ", " + to_string(hi) + "]");
+  }
+  return v;
+}
+
+inline bool configBool(const Dictionary &dict, const string &key) {
+  try {
+    return dict.getBool(key);
+  } catch (exception &) {
+    throw ConfigError(key + "=" + dict.getString(key) + " is not Y or N");
+  }
+}
+
+// A venue or symbol name with surrounding blanks removed, or "" if it is
+// not valid. Names end up in file, directory and shared-memory key names, so
+// only letters, digits, '.', '_' and '-' are allowed.
+inline string trimmedName(const string &value) {
+  size_t first = value.find_first_not_of(" \t");
+  if (first == string::npos)
+    return "";
+  string name = value.substr(first, value.find_last_not_of(" \t") - first + 1);
+  for (char c : name) {
+    if (!isalnum(static_cast<unsigned char>(c)) && c != '.' && c != '_' &&
+        c != '-')
+      return "";
+  }
+  return name;
+}
+
+inline string configName(const string &key, const string &value) {
+  string name = trimmedName(value);
+  if (name.empty())
+    throw ConfigError(key + "=" + value + " is not a valid name");
+  return name;
+}
+
+// Comma-separated names; empty entries and duplicates are errors.
+inline vector<string> configList(const string &key, const string &value) {
+  vector<string> names;
+  stringstream ss(value);
+  string item;
+  while (getline(ss, item, ',')) {
+    string name = trimmedName(item);
+    if (name.empty()) {
+      throw ConfigError(key + "=" + value + ": '" + item +
+                        "' is not a valid name");
+    }
+    if (find(names.begin(), names.end(), name) != names.end())
+      throw ConfigError(key + "=" + value + ": duplicate '" + name + "'");
+    names.push_back(move(name));
+  }
+  if (names.empty() || value.back() == ',')
+    throw ConfigError(key + "=" + value + " has an empty entry");
+  return names;
+}
@@ -0,0 +1,87 @@
+#pragma once
+
+#include "MarketDataTypes.h"
+#include <bits/stdc++.h>
+
+using namespace std;
+
+// Latest quote per venue plus the consolidated best bid/offer per symbol.
+// Not thread-safe. QuoteFeedServer guards its book with its mutex;
+// FIXMarketDataApp only touches its book from the initiator thread.
+class ConsolidatedBook {
+public:
+  // Applies a venue quote. A one-sided update keeps the venue's other side.
+  void apply(WSMessage msg) {
+    if (msg.venueDown) {
+      removeVenue(msg.venue);
+      return;
+    }
+    auto &book = m_venues[msg.venue];
+    auto it = book.find(msg.symbol);
+    if (it != book.end()) {
+      if (msg.bid == kNoPrice)
+        msg.bid = it->second.bid;
+      if (msg.ask == kNoPrice)
+        msg.ask = it->second.ask;
+    }
+    book[msg.symbol] = msg;
+    refresh(msg);
+  }
+
+  // Drops every quote of `venue` (its session logged out) and recomputes
+  // the BBO of the symbols it quoted. Returns those symbols; a symbol no
+  // venue quotes any more disappears from consolidated().
+  vector<string> removeVenue(const string &venue) {
+    vector<string> symbols;
+    auto it = m_venues.find(venue);
+    if (it == m_venues.end())
+      return symbols;
+    for (const auto &[symbol, q] : it->second)
+      symbols.push_back(symbol);
+    m_venues.erase(it);
+    for (const auto &symbol : symbols) {
+      WSMessage latest;
+      latest.symbol = symbol;
+      auto current = m_consolidated.find(symbol);
+      if (current != m_consolidated.end()) {
+        latest.scale = current->second.scale;
+        latest.timestamp = current->second.timestamp;
+      }
+      refresh(latest);
+    }
+    return symbols;
+  }
+
+  const QuoteBook &consolidated() const { return m_consolidated; }
+  const map<string, QuoteBook> &venues() const { return m_venues; }
+  bool empty() const { return m_consolidated.empty(); }
+
+private:
+  // Recomputes the BBO for the symbol of `latest`; cost is one lookup per
+  // venue, and venue counts are small.
+  void refresh(const WSMessage &latest) {
+    WSMessage best;
+    best.symbol = latest.symbol;
+    best.scale = latest.scale;
+    best.timestamp = latest.timestamp;
+    bool quoted = false;
+    for (const auto &[venue, book] : m_venues) {
+      auto it = book.find(latest.symbol);
+      if (it == book.end())
+        continue;
+      quoted = true;
+      const WSMessage &q = it->second;
+      if (q.bid != kNoPrice && (best.bid == kNoPrice || q.bid > best.bid))
+        best.bid = q.bid;
+      if (q.ask != kNoPrice && (best.ask == kNoPrice || q.ask < best.ask))
+        best.ask = q.ask;
+    }
+    if (quoted)
+      m_consolidated[latest.symbol] = best;
+    else
+      m_consolidated.erase(latest.symbol);
+  }
+
+  map<string, QuoteBook> m_venues;
+  QuoteBook m_consolidated;
+};
@@ -4,42 +4,84 @@
 #include <quickfix/Application.h>
 #include <quickfix/MessageCracker.h>
 #include <quickfix/Session.h>
+#include <quickfix/SessionSettings.h>
 #include <quickfix/Values.h>
 #include <quickfix/fix44/MarketDataIncrementalRefresh.h>
 #include <quickfix/fix44/MarketDataRequest.h>
 #include <quickfix/fix44/MarketDataSnapshotFullRefresh.h>
 
 #include "../Logger.h"
+#include "ClientConfig.h"
+#include "ConsolidatedBook.h"
+#include "MarketDataTypes.h"
 #include "OHLCBarAggregator.h"
+#include "SharedMarketDataPublisher.h"
+#include "TickJournal.h"
+#include "Timeframe.h"
 
 using namespace std;
 using namespace FIX;
 using namespace Logger;
 
-struct WSMessage {
-  string symbol;
-  double bid;
-  double ask;
-  long long timestamp;
-};
+// Half-spread used to synthesize a quote around a trade: 10 increments, i.e.
+// one pip for both 5-decimal and 3-decimal (JPY) quoting.
+constexpr FixedPrice kSyntheticHalfSpread = 10;
 
+// One process can run several initiator sessions (venues). Each session is
+// tagged with its VenueID setting (default: TargetCompID) and ticks are
+// aggregated per venue; sessions sharing a VenueID share an aggregator.
 class FIXMarketDataApp : public Application, public MessageCracker {
 public:
-  FIXMarketDataApp(OHLCBarAggregator &ohlc) : m_ohlc(ohlc) {
+  FIXMarketDataApp(const SessionSettings &settings, const string &clientId) {
+    const Dictionary &defaults = settings.get();
+    vector<Timeframe> timeframes = configuredTimeframes(defaults);
+    // Symbols=<list> sets what each session subscribes to
+    if (defaults.has("Symbols")) {
+      m_symbols = configList("Symbols", defaults.getString("Symbols"));
+    } else {
+      m_symbols = {"EURUSD", "GBPUSD", "USDJPY"};
+    }
+    // LogTrades=N turns off the per-trade log line (use under load)
+    if (defaults.has("LogTrades"))
+      m_logTrades = configBool(defaults, "LogTrades");
+    set<SessionID> sessions = settings.getSessions();
+    bool multiVenue = sessions.size() > 1;
+    for (const auto &sessionID : sessions) {
+      const Dictionary &dict = settings.get(sessionID);
+      string venue = dict.has("VenueID")
+                         ? configName("VenueID", dict.getString("VenueID"))
+                         : sessionID.getTargetCompID().getString();
+      auto &ohlc = m_aggregators[venue];
+      if (!ohlc) {
+        // A single session keeps the flat OHLC_price_data_<id> layout
+        ohlc = make_unique<OHLCBarAggregator>(
+            clientId, multiVenue ? venue : "", timeframes);
+      }
+      m_venues[sessionID] = {venue, ohlc.get(), {}, {}};
+      info("Session " + sessionID.toString() + " -> venue " + venue);
+    }
     m_lastStatusUpdate = chrono::system_clock::now();
+    m_barClock = thread([this]() { barClockLoop(); });
   }
 
+  ~FIXMarketDataApp() { stopBarClock(); }
+
   void onCreate(const SessionID &sessionID) noexcept override {
     info("Session created: " + sessionID.toString());
   }
   void onLogon(const SessionID &sessionID) noexcept override {
     info("Logon: " + sessionID.toString());
-    subscribe(sessionID, "EURUSD");
-    subscribe(sessionID, "GBPUSD");
-    subscribe(sessionID, "USDJPY");
+    ++m_venueLogons[m_venues.at(sessionID).name];
+    for (const auto &symbol : m_symbols)
+      subscribe(sessionID, symbol);
   }
   void onLogout(const SessionID &sessionID) noexcept override {
     info("Logout: " + sessionID.toString());
+    // QuickFIX also reports a logout for a session that never logged on
+    const string &venue = m_venues.at(sessionID).name;
+    auto it = m_venueLogons.find(venue);
+    if (it != m_venueLogons.end() && it->second > 0 && --it->second == 0)
+      withdrawVenue(venue);
   }
 
   void toAdmin(Message &message, const SessionID &sessionID) noexcept override {
@@ -54,7 +96,9 @@ public:
   }
 
   void onMessage(const FIX44::MarketDataSnapshotFullRefresh &message,
-                 const SessionID &) override {
+                 const SessionID &sessionID) override {
+    Venue &venue = m_venues.at(sessionID);
+    MessageTimes times = messageTimes(message);
     Symbol symbol;
     message.get(symbol);
 
@@ -62,7 +106,8 @@ public:
     message.get(noMDEntries);
 
     FIX44::MarketDataSnapshotFullRefresh::NoMDEntries group;
-    double bid = 0, ask = 0, last = 0;
+    PriceScale scale = scaleOf(venue, symbol.getString());
+    FixedPrice bid = 0, ask = 0;
 
     for (int i = 1; i <= noMDEntries; ++i) {
       message.getGroup(i, group);
@@ -71,23 +116,27 @@ public:
       group.get(type);
       group.get(px);
 
+      FixedPrice fixedPx = scale.fromDouble(px);
+      if (m_journal)
+        captureTick(venue, symbol.getString(), type, fixedPx, 0, scale, times);
       if (type == MDEntryType_BID)
-        bid = px;
+        bid = fixedPx;
       else if (type == MDEntryType_OFFER)
-        ask = px;
+        ask = fixedPx;
       else if (type == MDEntryType_TRADE) {
-        last = px;
-        m_ohlc.onPrice(symbol.getString(), px, 0);
+        venue.ohlc->onPrice(symbol.getString(), fixedPx, 0);
       }
     }
 
     if (bid > 0 && ask > 0) {
-      pushWSUpdate(symbol.getString(), bid, ask);
+      pushWSUpdate(venue.name, symbol.getString(), bid, ask, scale);
     }
   }
 
   void onMessage(const FIX44::MarketDataIncrementalRefresh &message,
-                 const SessionID &) override {
+                 const SessionID &sessionID) override {
+    Venue &venue = m_venues.at(sessionID);
+    MessageTimes times = messageTimes(message);
     NoMDEntries noMDEntries;
     message.get(noMDEntries);
 
@@ -105,30 +154,141 @@ public:
       group.get(size);
 
       string sym = symbol.getString();
+      PriceScale scale = scaleOf(venue, sym);
+      FixedPrice fixedPx = scale.fromDouble(px);
+      if (m_journal)
+        captureTick(venue, sym, type, fixedPx, (long)size, scale, times);
       if (type == MDEntryType_TRADE) {
-        m_ohlc.onPrice(sym, px, (long)size);
-        info("Trade: " + sym + " Price=" + to_string(px.getValue()) +
-             " Volume=" + to_string((long)size));
+        venue.ohlc->onPrice(sym, fixedPx, (long)size);
+        if (m_logTrades) {
+          info("Trade: " + venue.name + " " + sym +
+               " Price=" + scale.toString(fixedPx) +
+               " Volume=" + to_string((long)size));
+        }
 
-        pushWSUpdate(sym, px.getValue() - 0.0001, px.getValue() + 0.0001);
+        pushWSUpdate(venue.name, sym, fixedPx - kSyntheticHalfSpread,
+                     fixedPx + kSyntheticHalfSpread, scale);
       } else if (type == MDEntryType_BID) {
-        pushWSUpdate(sym, px.getValue(), -1.0);
+        pushWSUpdate(venue.name, sym, fixedPx, kNoPrice, scale);
       } else if (type == MDEntryType_OFFER) {
-        pushWSUpdate(sym, -1.0, px.getValue());
+        pushWSUpdate(venue.name, sym, kNoPrice, fixedPx, scale);
       }
     }
   }
 
+  // Stops the WallClock bar thread. Call before flushAll() on shutdown, so
+  // no bar closes afterwards into a flushed file or a released publisher.
+  void stopBarClock() {
+    {
+      lock_guard<mutex> lock(m_barClockMutex);
+      m_barClockRunning = false;
+    }
+    m_barClockCv.notify_one();
+    if (m_barClock.joinable())
+      m_barClock.join();
+  }
+
+  void flushAll() {
+    for (auto &[venue, ohlc] : m_aggregators)
+      ohlc->flushAll();
+  }
+
+  // Timeframes of the aggregators (identical for every venue).
+  vector<int64_t> timeframeSeconds() const {
+    return m_aggregators.empty() ? vector<int64_t>()
+                                 : m_aggregators.begin()->second
+                                       ->timeframeSeconds();
+  }
+
+  // In WallClock mode (the default) bars close on the second their bucket
+  // ends; in EventTime mode only tick timestamps close them, which suits a
+  // replay driving the app, not live sessions. Call before the initiator
+  // starts.
+  void setBarClose(BarCloseMode mode, bool emitEmptyBars) {
+    for (auto &[venue, ohlc] : m_aggregators)
+      ohlc->setBarClose(mode, emitEmptyBars);
+    lock_guard<mutex> lock(m_barClockMutex);
+    m_barCloseMode = mode;
+  }
+
+  // Appends every decoded entry to the tick journal. Call before the
+  // initiator starts.
+  void setJournal(TickJournal *journal) { m_journal = journal; }
+
+  // Publishes the consolidated top of book and the current bars to shared
+  // memory as they change. Call before the initiator starts.
+  void setSharedMemory(SharedMarketDataPublisher *shm) {
+    m_shm = shm;
+    for (auto &[venue, ohlc] : m_aggregators)
+      ohlc->setSharedMemory(shm);
+  }
+
   bool popWSUpdate(WSMessage &msg) {
     lock_guard<mutex> lock(m_wsMutex);
     if (m_wsQueue.empty())
       return false;
     msg = m_wsQueue.front();
-    m_wsQueue.pop();
+    m_wsQueue.pop_front();
     return true;
   }
 
 private:
+  struct Venue {
+    string name;
+    OHLCBarAggregator *ohlc = nullptr;
+    unordered_map<string, uint32_t> journalIds;
+    // Resolved once per symbol so the ingest path skips the shared lock
+    unordered_map<string, PriceScale> scales;
+  };
+
+  struct MessageTimes {
+    int64_t eventNs = 0;
+    int64_t receiveNs = 0;
+  };
+
+  // Timeframes=<list> (e.g. 2s,1m,3m,1h,1d) replaces the default set;
+  // DailySessionStart=HH:MM (UTC) is when daily and longer bars open.
+  static vector<Timeframe> configuredTimeframes(const Dictionary &defaults) {
+    int64_t sessionStart = 0;
+    if (defaults.has("DailySessionStart")) {
+      sessionStart = Timeframes::parseSessionStart(
+          defaults.getString("DailySessionStart"));
+    }
+    if (!defaults.has("Timeframes"))
+      return Timeframes::defaults();
+    vector<Timeframe> timeframes =
+        Timeframes::parseList(defaults.getString("Timeframes"), sessionStart);
+    string names;
+    for (const auto &tf : timeframes)
+      names += (names.empty() ? "" : ",") + tf.name;
+    info("Timeframes: " + names +
+         (Timeframes::isDefault(timeframes) ? "" : " (custom set)"));
+    return timeframes;
+  }
+
+  // Wakes just after each whole second and lets the aggregators close the
+  // bars that ended on it.
+  void barClockLoop() {
+    unique_lock<mutex> lock(m_barClockMutex);
+    while (m_barClockRunning) {
+      auto now = chrono::system_clock::now();
+      auto next = chrono::time_point_cast<chrono::seconds>(now) +
+                  chrono::seconds(1);
+      if (m_barClockCv.wait_until(lock, next,
+                                  [this]() { return !m_barClockRunning; }))
+        break;
+      if (m_barCloseMode != BarCloseMode::WallClock)
+        continue;
+      long long epoch = chrono::duration_cast<chrono::seconds>(
+                            chrono::system_clock::now().time_since_epoch())
+                            .count();
+      lock.unlock();
+      for (auto &[venue, ohlc] : m_aggregators)
+        ohlc->advanceTo(epoch);
+      lock.lock();
+    }
+  }
+
   void subscribe(const SessionID &sessionID, const string &symbol) {
     FIX44::MarketDataRequest request;
     request.set(MDReqID("MD_" + symbol));
@@ -153,31 +313,152 @@ private:
     info("Subscribing to market data for: " + symbol);
   }
 
-  void pushWSUpdate(const string &symbol, double bid, double ask) {
-    lock_guard<mutex> lock(m_wsMutex);
+  void pushWSUpdate(const string &venue, const string &symbol, FixedPrice bid,
+                    FixedPrice ask, const PriceScale &scale) {
+    if (m_shm)
+      publishTopOfBook(venue, symbol, bid, ask, scale);
+
     WSMessage msg;
     msg.symbol = symbol;
+    msg.venue = venue;
     msg.bid = bid;
     msg.ask = ask;
+    msg.scale = scale;
     msg.timestamp = chrono::duration_cast<chrono::seconds>(
                         chrono::system_clock::now().time_since_epoch())
                         .count();
-    m_wsQueue.push(msg);
-    if (m_wsQueue.size() > 100)
-      m_wsQueue.pop(); // Prevent overflow
+    queueWSUpdate(move(msg));
+  }
+
+  void queueWSUpdate(WSMessage msg) {
+    lock_guard<mutex> lock(m_wsMutex);
+    m_wsQueue.push_back(move(msg));
+    if (m_wsQueue.size() > 100) {
+      // Prevent overflow by dropping the oldest quote; a venue withdrawal
+      // is never dropped
+      auto oldest = find_if(m_wsQueue.begin(), m_wsQueue.end(),
+                            [](const WSMessage &m) { return !m.venueDown; });
+      if (oldest != m_wsQueue.end())
+        m_wsQueue.erase(oldest);
+    }
+  }
+
+  // The venue's last session logged out: take its quotes out of the
+  // consolidated book in shared memory and on the WebSocket feed.
+  void withdrawVenue(const string &venue) {
+    info("Withdrawing quotes of venue " + venue);
+    if (m_shm) {
+      for (const auto &symbol : m_topOfBook.removeVenue(venue)) {
+        auto slot = m_shmQuoteSlots.find(symbol);
+        if (slot == m_shmQuoteSlots.end() || !slot->second)
+          continue;
+        const QuoteBook &book = m_topOfBook.consolidated();
+        auto best = book.find(symbol);
+        WSMessage none;
+        none.symbol = symbol;
+        none.scale = PriceScales::forSymbol(symbol);
+        m_shm->publishQuote(*slot->second,
+                            best != book.end() ? best->second : none);
+      }
+    }
+    WSMessage msg;
+    msg.venue = venue;
+    msg.venueDown = true;
+    queueWSUpdate(move(msg));
+  }
+
+  static PriceScale scaleOf(Venue &venue, const string &symbol) {
+    auto it = venue.scales.find(symbol);
+    if (it == venue.scales.end())
+      it = venue.scales.emplace(symbol, PriceScales::forSymbol(symbol)).first;
+    return it->second;
+  }
+
+  static MessageTimes messageTimes(const Message &message) {
+    MessageTimes times;
+    times.receiveNs = chrono::duration_cast<chrono::nanoseconds>(
+                          chrono::system_clock::now().time_since_epoch())
+                          .count();
+    SendingTime sendingTime;
+    if (message.getHeader().getFieldIfSet(sendingTime)) {
+      const UtcTimeStamp &ts = sendingTime.getValue();
+      times.eventNs = static_cast<int64_t>(ts.getTimeT()) * 1000000000LL +
+                      static_cast<int64_t>(ts.getMillisecond()) * 1000000LL;
+    }
+    return times;
+  }
+
+  void captureTick(Venue &venue, const string &symbol, char type,
+                   FixedPrice px, long size, const PriceScale &scale,
+                   const MessageTimes &times) {
+    auto it = venue.journalIds.find(symbol);
+    if (it == venue.journalIds.end()) {
+      it = venue.journalIds
+               .emplace(symbol, m_journal->registerSymbol(venue.name, symbol))
+               .first;
+    }
+    JournalRecord record{};
+    record.symbolId = it->second;
+    record.type = type == MDEntryType_BID     ? JournalTickType::Bid
+                  : type == MDEntryType_OFFER ? JournalTickType::Offer
+                                              : JournalTickType::Trade;
+    record.decimals = static_cast<uint8_t>(scale.decimals);
+    record.price = px;
+    record.size = size;
+    record.eventTimeNs = times.eventNs;
+    record.receiveTimeNs = times.receiveNs;
+    m_journal->append(record);
+  }
+
+  // Runs on the initiator thread, which is the only writer of quote slots.
+  void publishTopOfBook(const string &venue, const string &symbol,
+                        FixedPrice bid, FixedPrice ask,
+                        const PriceScale &scale) {
+    WSMessage msg;
+    msg.symbol = symbol;
+    msg.venue = venue;
+    msg.bid = bid;
+    msg.ask = ask;
+    msg.scale = scale;
+    m_topOfBook.apply(msg);
+
+    auto it = m_shmQuoteSlots.find(symbol);
+    if (it == m_shmQuoteSlots.end())
+      it = m_shmQuoteSlots.emplace(symbol, m_shm->slotFor(symbol)).first;
+    if (it->second)
+      m_shm->publishQuote(*it->second, m_topOfBook.consolidated().at(symbol));
   }
 
   void checkStatusUpdate() {
     auto now = chrono::system_clock::now();
     if (chrono::duration_cast<chrono::seconds>(now - m_lastStatusUpdate)
             .count() >= 60) {
-      m_ohlc.printCurrentState();
+      for (auto &[venue, ohlc] : m_aggregators)
+        ohlc->printCurrentState();
       m_lastStatusUpdate = now;
     }
   }
 
-  OHLCBarAggregator &m_ohlc;
-  queue<WSMessage> m_wsQueue;
+  // Filled in the constructor and only read afterwards.
+  vector<string> m_symbols;
+  bool m_logTrades = true;
+  map<string, unique_ptr<OHLCBarAggregator>> m_aggregators;
+  map<SessionID, Venue> m_venues;
+  // Logged-on sessions per venue name; initiator thread only
+  map<string, int> m_venueLogons;
+  SharedMarketDataPublisher *m_shm = nullptr;
+  TickJournal *m_journal = nullptr;
+  // Initiator thread only, like m_venueLogons: SocketInitiator delivers
+  // quotes and logouts (withdrawVenue) for every session on one thread
+  ConsolidatedBook m_topOfBook;
+  unordered_map<string, optional<uint32_t>> m_shmQuoteSlots;
+  deque<WSMessage> m_wsQueue;
   mutex m_wsMutex;
   chrono::system_clock::time_point m_lastStatusUpdate;
+
+  BarCloseMode m_barCloseMode = BarCloseMode::WallClock;
+  bool m_barClockRunning = true;
+  mutex m_barClockMutex;
+  condition_variable m_barClockCv;
+  thread m_barClock;
 };
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <bits/stdc++.h>
+
+using namespace std;
+
+// Prices are carried as a whole number of the symbol's price increment,
+// e.g. 108500 for EURUSD 1.08500 (5 decimals) or 150000 for USDJPY 150.000
+// (3 decimals). Comparisons are exact and high/low updates are integer ops.
+using FixedPrice = int64_t;
+
+// Marks the missing side of a one-sided quote update.
+constexpr FixedPrice kNoPrice = numeric_limits<FixedPrice>::min();
+
+struct PriceScale {
+  int decimals = 5;
+  int64_t unit = 100000; // increments per 1.0
+
+  static PriceScale fromDecimals(int decimals) {
+    if (decimals < 0 || decimals > 9) {
+      throw invalid_argument("Price decimals out of range: " +
+                             to_string(decimals));
+    }
+    PriceScale scale;
+    scale.decimals = decimals;
+    scale.unit = 1;
+    for (int i = 0; i < decimals; ++i)
+      scale.unit *= 10;
+    return scale;
+  }
+
+  FixedPrice fromDouble(double px) const {
+    return static_cast<FixedPrice>(llround(px * static_cast<double>(unit)));
+  }
+
+  double toDouble(FixedPrice px) const {
+    return static_cast<double>(px) / static_cast<double>(unit);
+  }
+
+  // Writes px with exactly `decimals` fraction digits into [first, last) and
+  // returns one past the last character written. 32 bytes always suffice.
+  char *format(char *first, char *last, FixedPrice px) const {
+    if (px < 0) {
+      *first++ = '-';
+    }
+    uint64_t mag = px < 0 ? 0 - static_cast<uint64_t>(px)
+                          : static_cast<uint64_t>(px);
+    uint64_t u = static_cast<uint64_t>(unit);
+    first = to_chars(first, last, mag / u).ptr;
+    if (decimals > 0) {
+      *first++ = '.';
+      char digits[20];
+      char *end = to_chars(digits, digits + sizeof(digits), mag % u).ptr;
+      int len = static_cast<int>(end - digits);
+      for (int i = len; i < decimals; ++i)
+        *first++ = '0';
+      memcpy(first, digits, len);
+      first += len;
+    }
+    return first;
+  }
+
+  string toString(FixedPrice px) const {
+    char buf[32];
+    return string(buf, format(buf, buf + sizeof(buf), px));
+  }
+};
+
+// Per-symbol price increments. Configure before the FIX initiator starts;
+// symbols without an explicit entry use the default (5 decimals).
+namespace PriceScales {
+inline unordered_map<string, PriceScale> scales;
+inline PriceScale defaultScale = PriceScale::fromDecimals(5);
+inline shared_mutex scalesMutex;
+
+inline void setDefaultDecimals(int decimals) {
+  unique_lock<shared_mutex> lock(scalesMutex);
+  defaultScale = PriceScale::fromDecimals(decimals);
+}
+
+inline void setDecimals(const string &symbol, int decimals) {
+  unique_lock<shared_mutex> lock(scalesMutex);
+  scales[symbol] = PriceScale::fromDecimals(decimals);
+}
+
+inline PriceScale forSymbol(const string &symbol) {
+  shared_lock<shared_mutex> lock(scalesMutex);
+  auto it = scales.find(symbol);
+  return it != scales.end() ? it->second : defaultScale;
+}
+} // namespace PriceScales
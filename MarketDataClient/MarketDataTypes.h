@@ -0,0 +1,54 @@
+#pragma once
+
+#include "FixedPrice.h"
+#include <bits/stdc++.h>
+
+using namespace std;
+
+struct OHLCBar {
+  chrono::system_clock::time_point timestamp;
+  FixedPrice open = 0, high = 0, low = 0, close = 0;
+  long volume = 0;
+  int tick_count = 0;
+
+  void update(FixedPrice price, long vol = 0) {
+    if (tick_count == 0) {
+      open = high = low = close = price;
+    } else {
+      if (price > high)
+        high = price;
+      if (price < low)
+        low = price;
+      close = price;
+    }
+    volume += vol;
+    tick_count++;
+  }
+
+  bool isEmpty() const { return tick_count == 0; }
+};
+
+// A timestamped trade used by the batch (backfill / replay) path. The price
+// is in the symbol's increments (see PriceScales).
+struct Tick {
+  string symbol;
+  FixedPrice price = 0;
+  long volume = 0;
+  chrono::system_clock::time_point timestamp;
+};
+
+// A missing side is kNoPrice. Venue is the FIX session the quote came from;
+// it is empty for consolidated (best across venues) quotes. With venueDown
+// set the message carries no quote and withdraws all of the venue's quotes.
+struct WSMessage {
+  string symbol;
+  string venue;
+  FixedPrice bid = kNoPrice;
+  FixedPrice ask = kNoPrice;
+  PriceScale scale;
+  long long timestamp = 0;
+  bool venueDown = false;
+};
+
+// Latest quote per symbol, as cached by the publisher.
+using QuoteBook = map<string, WSMessage>;
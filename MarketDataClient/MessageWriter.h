@@ -0,0 +1,263 @@
+#pragma once
+
+#include "ConsolidatedBook.h"
+#include "FixedPrice.h"
+#include "MarketDataTypes.h"
+#include <bits/stdc++.h>
+
+using namespace std;
+
+// Append-only output buffer. clear() keeps the capacity, so a buffer that is
+// reused across publish intervals stops allocating once it has warmed up.
+class MessageBuffer {
+public:
+  void clear() { m_data.clear(); }
+
+  void append(char c) { m_data.push_back(c); }
+  void append(string_view s) { m_data.append(s.data(), s.size()); }
+
+  void appendInt(long long v) {
+    char buf[24];
+    m_data.append(buf, to_chars(buf, buf + sizeof(buf), v).ptr - buf);
+  }
+
+  // Contents of a JSON string: quote and backslash are escaped, control
+  // characters written as \u00XX.
+  void appendJsonEscaped(string_view s) {
+    static constexpr char kHex[] = "0123456789abcdef";
+    for (char c : s) {
+      auto u = static_cast<unsigned char>(c);
+      if (c == '"' || c == '\\') {
+        m_data.push_back('\\');
+        m_data.push_back(c);
+      } else if (u < 0x20) {
+        m_data.append("\\u00");
+        m_data.push_back(kHex[u >> 4]);
+        m_data.push_back(kHex[u & 0xF]);
+      } else {
+        m_data.push_back(c);
+      }
+    }
+  }
+
+  void appendPrice(FixedPrice px, const PriceScale &scale) {
+    char buf[32];
+    m_data.append(buf, scale.format(buf, buf + sizeof(buf), px) - buf);
+  }
+
+  // Little-endian fixed-width field for the binary encoding.
+  template <typename T> void appendRaw(T v) {
+    static_assert(is_integral_v<T>, "appendRaw takes integral fields");
+    char bytes[sizeof(T)];
+    using U = make_unsigned_t<T>;
+    U u = static_cast<U>(v);
+    for (size_t i = 0; i < sizeof(T); ++i)
+      bytes[i] = static_cast<char>((u >> (8 * i)) & 0xFF);
+    m_data.append(bytes, sizeof(T));
+  }
+
+  const char *data() const { return m_data.data(); }
+  size_t size() const { return m_data.size(); }
+  bool empty() const { return m_data.empty(); }
+  // The WebSocket API takes std::string, so expose the storage directly.
+  const string &str() const { return m_data; }
+
+private:
+  string m_data;
+};
+
+// Per-client wire format for the WebSocket feed. Clients start on Json and
+// can switch by sending {"encoding":"binary"}.
+enum class Encoding { Json, Binary };
+
+// Reads a client's encoding request: a flat JSON object with string values
+// whose "encoding" member is "json" or "binary". Anything else, including
+// malformed JSON, yields nullopt.
+inline optional<Encoding> parseEncodingRequest(string_view text) {
+  size_t i = 0;
+  auto skipBlanks = [&]() {
+    while (i < text.size() && isspace(static_cast<unsigned char>(text[i])))
+      ++i;
+  };
+  auto consume = [&](char c) {
+    skipBlanks();
+    if (i == text.size() || text[i] != c)
+      return false;
+    ++i;
+    return true;
+  };
+  // Raw contents of a string; escapes are skipped over, not decoded
+  auto readString = [&]() -> optional<string_view> {
+    if (!consume('"'))
+      return nullopt;
+    size_t start = i;
+    while (i < text.size() && text[i] != '"')
+      i += text[i] == '\\' ? 2 : 1;
+    if (i >= text.size())
+      return nullopt;
+    return text.substr(start, i++ - start);
+  };
+
+  optional<string_view> encoding;
+  if (!consume('{'))
+    return nullopt;
+  if (!consume('}')) {
+    do {
+      auto key = readString();
+      if (!key || !consume(':'))
+        return nullopt;
+      auto value = readString();
+      if (!value)
+        return nullopt;
+      if (*key == "encoding")
+        encoding = value;
+    } while (consume(','));
+    if (!consume('}'))
+      return nullopt;
+  }
+  skipBlanks();
+  if (i != text.size() || !encoding)
+    return nullopt;
+  if (*encoding == "json")
+    return Encoding::Json;
+  if (*encoding == "binary")
+    return Encoding::Binary;
+  return nullopt;
+}
+
+// Writers for the fixed message shapes (quote, book, bar). Each shape gets
+// its own specialization so field names and layout are compile-time
+// constants; nothing is built up as a generic document first.
+template <typename Shape> struct JsonWriter;
+template <typename Shape> struct BinaryWriter;
+template <typename Shape> struct CsvWriter;
+
+template <> struct JsonWriter<WSMessage> {
+  // Symbols and venues come from config and the FIX feed, so they are
+  // escaped. Consolidated quotes carry no "venue" key.
+  static void write(MessageBuffer &out, const WSMessage &q,
+                    long long timestamp) {
+    out.append("{\"symbol\":\"");
+    out.appendJsonEscaped(q.symbol);
+    if (!q.venue.empty()) {
+      out.append("\",\"venue\":\"");
+      out.appendJsonEscaped(q.venue);
+    }
+    out.append("\",\"bid\":");
+    out.appendPrice(q.bid, q.scale);
+    out.append(",\"ask\":");
+    out.appendPrice(q.ask, q.scale);
+    out.append(",\"timestamp\":");
+    out.appendInt(timestamp);
+    out.append('}');
+  }
+};
+
+// Visits the two-sided quotes of a book: the consolidated BBO first, then the
+// per-venue quotes when more than one venue is connected.
+template <typename Fn>
+void forEachBookQuote(const ConsolidatedBook &book, Fn fn) {
+  auto emit = [&fn](const QuoteBook &quotes) {
+    for (const auto &[symbol, q] : quotes) {
+      if (q.bid != kNoPrice && q.ask != kNoPrice)
+        fn(q);
+    }
+  };
+  emit(book.consolidated());
+  if (book.venues().size() > 1) {
+    for (const auto &[venue, quotes] : book.venues())
+      emit(quotes);
+  }
+}
+
+template <> struct JsonWriter<ConsolidatedBook> {
+  // All quotes as one JSON array.
+  static void write(MessageBuffer &out, const ConsolidatedBook &book,
+                    long long timestamp) {
+    out.append('[');
+    bool first = true;
+    forEachBookQuote(book, [&](const WSMessage &q) {
+      if (!first)
+        out.append(',');
+      JsonWriter<WSMessage>::write(out, q, timestamp);
+      first = false;
+    });
+    out.append(']');
+  }
+};
+
+// Binary layout, little-endian:
+//   quote: u8 symbolLen, symbol, u8 venueLen, venue, u8 decimals,
+//          i64 bid, i64 ask, i64 timestamp
+//   book:  u8 'B', u32 count, count * quote
+// Prices are raw increments; divide by 10^decimals to get the quote. An
+// empty venue marks the consolidated quote. A quote whose symbol or venue
+// is longer than 255 bytes cannot be encoded and is left out of the book.
+template <> struct BinaryWriter<WSMessage> {
+  static bool fits(const WSMessage &q) {
+    return q.symbol.size() <= numeric_limits<uint8_t>::max() &&
+           q.venue.size() <= numeric_limits<uint8_t>::max();
+  }
+
+  // Writes nothing and returns false if the quote does not fit.
+  static bool write(MessageBuffer &out, const WSMessage &q,
+                    long long timestamp) {
+    if (!fits(q))
+      return false;
+    out.appendRaw(static_cast<uint8_t>(q.symbol.size()));
+    out.append(q.symbol);
+    out.appendRaw(static_cast<uint8_t>(q.venue.size()));
+    out.append(q.venue);
+    out.appendRaw(static_cast<uint8_t>(q.scale.decimals));
+    out.appendRaw(static_cast<int64_t>(q.bid));
+    out.appendRaw(static_cast<int64_t>(q.ask));
+    out.appendRaw(static_cast<int64_t>(timestamp));
+    return true;
+  }
+};
+
+template <> struct BinaryWriter<ConsolidatedBook> {
+  static void write(MessageBuffer &out, const ConsolidatedBook &book,
+                    long long timestamp) {
+    uint32_t count = 0;
+    forEachBookQuote(book, [&count](const WSMessage &q) {
+      count += BinaryWriter<WSMessage>::fits(q);
+    });
+    out.append('B');
+    out.appendRaw(count);
+    forEachBookQuote(book, [&](const WSMessage &q) {
+      BinaryWriter<WSMessage>::write(out, q, timestamp);
+    });
+  }
+};
+
+template <> struct CsvWriter<OHLCBar> {
+  static constexpr string_view header =
+      "Timestamp,Open,High,Low,Close,Volume,TickCount\n";
+
+  static void write(MessageBuffer &out, const OHLCBar &bar,
+                    const PriceScale &scale) {
+    out.appendInt(chrono::duration_cast<chrono::seconds>(
+                      bar.timestamp.time_since_epoch())
+                      .count());
+    for (FixedPrice px : {bar.open, bar.high, bar.low, bar.close}) {
+      out.append(',');
+      out.appendPrice(px, scale);
+    }
+    out.append(',');
+    out.appendInt(bar.volume);
+    out.append(',');
+    out.appendInt(bar.tick_count);
+    out.append('\n');
+  }
+};
+
+// Serializes a book in the requested encoding.
+inline void writeBook(MessageBuffer &out, Encoding encoding,
+                      const ConsolidatedBook &book, long long timestamp) {
+  out.clear();
+  if (encoding == Encoding::Binary)
+    BinaryWriter<ConsolidatedBook>::write(out, book, timestamp);
+  else
+    JsonWriter<ConsolidatedBook>::write(out, book, timestamp);
+}
@@ -1,110 +1,183 @@
 #pragma once
 
 #include "../Logger.h"
+#include "MarketDataTypes.h"
+#include "MessageWriter.h"
+#include "SharedMarketDataPublisher.h"
+#include "Timeframe.h"
+#include "TimingWheel.h"
 #include <bits/stdc++.h>
 
 using namespace std;
 using namespace Logger;
 namespace fs = filesystem;
 
-struct OHLCBar {
-  chrono::system_clock::time_point timestamp;
-  double open = 0.0, high = 0.0, low = 0.0, close = 0.0;
-  long volume = 0;
-  int tick_count = 0;
-
-  void update(double price, long vol = 0) {
-    if (tick_count == 0) {
-      open = high = low = close = price;
-    } else {
-      if (price > high)
-        high = price;
-      if (price < low)
-        low = price;
-      close = price;
-    }
-    volume += vol;
-    tick_count++;
-  }
-
-  bool isEmpty() const { return tick_count == 0; }
-};
-
-enum class Timeframe {
-  SEC_1 = 1,
-  SEC_5 = 5,
-  SEC_10 = 10,
-  SEC_15 = 15,
-  SEC_30 = 30,
-  MIN_1 = 60,
-  MIN_5 = 300,
-  MIN_15 = 900,
-  MIN_30 = 1800,
-  HOUR_1 = 3600,
-  HOUR_4 = 14400,
-};
+// What closes a bar at its bucket boundary. WallClock: a clock thread calls
+// advanceTo() every second. EventTime: only tick timestamps move time
+// forward; replay/backfill only, since live ticks carry no timestamp of
+// their own. Either way a tick for a later bucket still closes the bar if
+// the boundary has not been processed yet.
+enum class BarCloseMode { WallClock, EventTime };
 
 class OHLCBarAggregator {
 public:
-  OHLCBarAggregator(string clientId = "1") : m_clientId(clientId) {
-    string dataDir = "./OHLC_price_data_" + m_clientId;
-    if (!fs::exists(dataDir)) {
-      fs::create_directories(dataDir);
+  // With a venue, bars go to OHLC_price_data_<clientId>/<venue>/ so several
+  // FIX sessions in one process keep separate files. The default timeframe
+  // set runs on the compile-time DefaultTimeframes kernel; any other set
+  // uses the runtime bucket math.
+  OHLCBarAggregator(string clientId = "1", string venue = "",
+                    vector<Timeframe> timeframes = Timeframes::defaults())
+      : m_clientId(clientId), m_venue(venue),
+        m_timeframes(move(timeframes)),
+        m_defaultKernel(Timeframes::isDefault(m_timeframes)),
+        m_bucketCache(m_timeframes.size()),
+        m_wheel(chrono::duration_cast<chrono::seconds>(
+                    chrono::system_clock::now().time_since_epoch())
+                    .count()) {
+    m_dataDir = "./OHLC_price_data_" + m_clientId;
+    if (!m_venue.empty())
+      m_dataDir += "/" + m_venue;
+    if (!fs::exists(m_dataDir)) {
+      fs::create_directories(m_dataDir);
     }
-    m_timeframes = {Timeframe::SEC_1,  Timeframe::SEC_5,  Timeframe::SEC_10,
-                    Timeframe::SEC_15, Timeframe::SEC_30, Timeframe::MIN_1,
-                    Timeframe::MIN_5,  Timeframe::MIN_15, Timeframe::MIN_30,
-                    Timeframe::HOUR_1, Timeframe::HOUR_4};
   }
 
-  void onPrice(const string &symbol, double price, long volume) {
+  // A live tick, stamped with the wall clock. Use WallClock mode with it.
+  void onPrice(const string &symbol, FixedPrice price, long volume) {
     lock_guard<mutex> lock(m_mutex);
     auto now = chrono::system_clock::now();
     auto epoch =
         chrono::duration_cast<chrono::seconds>(now.time_since_epoch()).count();
 
-    for (auto tf : m_timeframes) {
-      int seconds = static_cast<int>(tf);
-      long long bucket = (epoch / seconds) * seconds;
-      auto bucket_tp = chrono::system_clock::from_time_t(bucket);
+    advanceLocked(epoch);
+    foldTick(symbol, price, volume, epoch);
+  }
+
+  // One tick with its own timestamp, e.g. from a recording. In EventTime
+  // mode it moves the bar clock to the tick; this is the scalar reference
+  // for onPrices.
+  void onPrice(const Tick &tick) {
+    lock_guard<mutex> lock(m_mutex);
+    auto epoch = chrono::duration_cast<chrono::seconds>(
+                     tick.timestamp.time_since_epoch())
+                     .count();
+    if (m_closeMode == BarCloseMode::EventTime)
+      advanceLocked(epoch);
+    foldTick(tick.symbol, tick.price, tick.volume, epoch);
+  }
 
-      auto &bar = m_bars[symbol][tf];
+  // Batch entry point for backfill and replay. One pass appends each tick to
+  // its symbol's SoA columns; each symbol's columns are then cut into runs
+  // of ticks from the same second, and every run is summarised once and
+  // folded into all timeframes. The lock is taken once per batch and bars
+  // closed during it are buffered per file and written once at the end.
+  // Produces the same bars as feeding the ticks one at a time through
+  // onPrice(Tick).
+  void onPrices(const vector<Tick> &ticks) {
+    if (ticks.empty())
+      return;
 
-      if (!bar.isEmpty() && bar.timestamp != bucket_tp) {
-        saveToCSV(symbol, tf, bar);
-        bar = OHLCBar(); // Reset
-      }
+    lock_guard<mutex> lock(m_mutex);
+    m_batching = true;
+    long long maxEpoch = numeric_limits<long long>::min();
+    for (const Tick &tick : ticks) {
+      size_t c = columnFor(tick.symbol);
+      SymbolColumns &col = m_columns[c];
+      if (col.epochs.empty())
+        m_touched.push_back(c);
+      long long epoch = chrono::duration_cast<chrono::seconds>(
+                            tick.timestamp.time_since_epoch())
+                            .count();
+      col.epochs.push_back(epoch);
+      col.prices.push_back(tick.price);
+      col.volumes.push_back(tick.volume);
+      maxEpoch = max(maxEpoch, epoch);
+    }
 
-      if (bar.isEmpty()) {
-        bar.timestamp = bucket_tp;
+    for (size_t c : m_touched) {
+      SymbolColumns &col = m_columns[c];
+      const long long *epochs = col.epochs.data();
+      size_t n = col.epochs.size();
+      size_t i = 0;
+      while (i < n) {
+        size_t j = i + 1;
+        while (j < n && epochs[j] == epochs[i])
+          ++j;
+        foldRun(col.entry->first, col.entry->second, epochs[i],
+                &col.prices[i], &col.volumes[i], j - i);
+        i = j;
       }
-      bar.update(price, volume);
+      col.epochs.clear();
+      col.prices.clear();
+      col.volumes.clear();
     }
+    m_touched.clear();
+
+    if (m_closeMode == BarCloseMode::EventTime)
+      advanceLocked(maxEpoch);
+    m_batching = false;
+    flushCsvOutputs();
+  }
+
+  void setBarClose(BarCloseMode mode, bool emitEmptyBars) {
+    lock_guard<mutex> lock(m_mutex);
+    m_closeMode = mode;
+    m_emitEmptyBars = emitEmptyBars;
+  }
+
+  // Closes every bar whose bucket ends at or before `epochSeconds`.
+  void advanceTo(long long epochSeconds) {
+    lock_guard<mutex> lock(m_mutex);
+    advanceLocked(epochSeconds);
+    flushCsvOutputs();
+  }
+
+  // Also publish the current bar of every (symbol, timeframe) to shared
+  // memory, keyed by symbol, or venue/symbol for a per-venue aggregator.
+  void setSharedMemory(SharedMarketDataPublisher *shm) {
+    lock_guard<mutex> lock(m_mutex);
+    m_shm = shm;
+    m_shmSlots.clear();
   }
 
+  vector<int64_t> timeframeSeconds() const {
+    vector<int64_t> seconds;
+    for (const auto &tf : m_timeframes)
+      seconds.push_back(tf.seconds);
+    return seconds;
+  }
+
+  // Writes every open bar and resets it, so a late timer cannot write it
+  // a second time.
   void flushAll() {
     lock_guard<mutex> lock(m_mutex);
     for (auto &symbol_pair : m_bars) {
-      for (auto &tf_pair : symbol_pair.second) {
-        if (!tf_pair.second.isEmpty()) {
-          saveToCSV(symbol_pair.first, tf_pair.first, tf_pair.second);
+      for (size_t t = 0; t < m_timeframes.size(); ++t) {
+        if (!symbol_pair.second[t].isEmpty()) {
+          saveToCSV(symbol_pair.first, t, symbol_pair.second[t]);
         }
+        symbol_pair.second[t] = OHLCBar();
       }
     }
+    flushCsvOutputs();
   }
 
   void printCurrentState() {
     lock_guard<mutex> lock(m_mutex);
-    info("--- Current OHLC State ---");
+    info(m_venue.empty() ? "--- Current OHLC State ---"
+                         : "--- Current OHLC State [" + m_venue + "] ---");
     for (auto &symbol_pair : m_bars) {
       info("Symbol: " + symbol_pair.first);
-      for (auto &tf_pair : symbol_pair.second) {
-        const auto &bar = tf_pair.second;
+      for (size_t t = 0; t < m_timeframes.size(); ++t) {
+        const auto &bar = symbol_pair.second[t];
         if (!bar.isEmpty()) {
+          PriceScale scale = PriceScales::forSymbol(symbol_pair.first);
           stringstream ss;
-          ss << "  TF " << timeframeToString(tf_pair.first) << ": "
-             << "O:" << bar.open << " H:" << bar.high << " L:" << bar.low
-             << " C:" << bar.close << " V:" << bar.volume
+          ss << "  TF " << m_timeframes[t].name << ": "
+             << "O:" << scale.toString(bar.open)
+             << " H:" << scale.toString(bar.high)
+             << " L:" << scale.toString(bar.low)
+             << " C:" << scale.toString(bar.close) << " V:" << bar.volume
              << " Ticks:" << bar.tick_count;
           info(ss.str());
         }
@@ -114,58 +187,331 @@ public:
   }
 
 private:
-  string timeframeToString(Timeframe tf) {
-    switch (tf) {
-    case Timeframe::SEC_1:
-      return "1s";
-    case Timeframe::SEC_5:
-      return "5s";
-    case Timeframe::SEC_10:
-      return "10s";
-    case Timeframe::SEC_15:
-      return "15s";
-    case Timeframe::SEC_30:
-      return "30s";
-    case Timeframe::MIN_1:
-      return "1m";
-    case Timeframe::MIN_5:
-      return "5m";
-    case Timeframe::MIN_15:
-      return "15m";
-    case Timeframe::MIN_30:
-      return "30m";
-    case Timeframe::HOUR_1:
-      return "1h";
-    case Timeframe::HOUR_4:
-      return "4h";
-    default:
-      return "unknown";
-    }
-  }
-
-  void saveToCSV(const string &symbol, Timeframe tf, const OHLCBar &bar) {
-    string filename = "./OHLC_price_data_" + m_clientId + "/" + symbol + "_" +
-                      timeframeToString(tf) + ".csv";
-
-    bool needsHeader = !fs::exists(filename) || fs::file_size(filename) == 0;
-
-    ofstream file(filename, ios::app);
-    if (file.is_open()) {
-      if (needsHeader) {
-        file << "Timestamp,Open,High,Low,Close,Volume,TickCount\n";
+  // Pending close for one open bar. `symbol` points at the m_bars key and
+  // `bar` into its value; both are stable because m_bars never erases and
+  // each symbol's bar vector is sized once. The bucket is kept here because
+  // the wheel fires a timer scheduled in its past late, not at its due time.
+  struct BarTimer {
+    const string *symbol;
+    size_t tfIndex;
+    OHLCBar *bar;
+    int64_t bucketStart;
+  };
+
+  using BarMap = unordered_map<string, vector<OHLCBar>>;
+
+  // onPrices staging for one symbol. `entry` is its m_bars element, whose
+  // address survives rehashing; the columns keep their capacity between
+  // batches.
+  struct SymbolColumns {
+    BarMap::value_type *entry;
+    vector<long long> epochs;
+    vector<FixedPrice> prices;
+    vector<long> volumes;
+  };
+
+  struct SymbolKey {
+    uint64_t head, tail;
+    size_t len;
+  };
+
+  struct ColumnSlot {
+    SymbolKey key{0, 0, 0};
+    int32_t column = -1; // -1: free
+  };
+
+  // Open, high, low, close, volume and count of a run of ticks.
+  struct RunSummary {
+    FixedPrice open, high, low, close;
+    long volume;
+    int ticks;
+  };
+
+  // One bar file. Whether it already has a header is checked on first use
+  // only; closed bars collect in `pending` until flushCsvOutputs().
+  struct CsvOutput {
+    string path;
+    PriceScale scale;
+    bool checked = false;
+    bool hasHeader = false;
+    MessageBuffer pending;
+  };
+
+  BarMap::iterator barsFor(const string &symbol) {
+    auto it = m_bars.try_emplace(symbol).first;
+    if (it->second.empty())
+      it->second.resize(m_timeframes.size());
+    return it;
+  }
+
+  // Bucket start of `epoch` for every timeframe. Ticks mostly arrive many
+  // per second, so the buckets are only recomputed when the second changes.
+  const long long *bucketsOf(long long epoch) {
+    if (epoch != m_cachedEpoch) {
+      if (m_defaultKernel) {
+        DefaultTimeframes::bucketsOf(epoch, m_bucketCache.data());
+      } else {
+        for (size_t t = 0; t < m_timeframes.size(); ++t)
+          m_bucketCache[t] = m_timeframes[t].bucketOf(epoch);
       }
-      auto timestamp = chrono::duration_cast<chrono::seconds>(
-                           bar.timestamp.time_since_epoch())
-                           .count();
-      file << timestamp << "," << fixed << setprecision(5) << bar.open << ","
-           << bar.high << "," << bar.low << "," << bar.close << ","
-           << bar.volume << "," << bar.tick_count << "\n";
+      m_cachedEpoch = epoch;
+    }
+    return m_bucketCache.data();
+  }
+
+  // Column of `symbol` in m_columns, added on first sight. This runs once
+  // per tick, so it avoids string hashing and compares: the key is the
+  // length plus up to 16 bytes read with fixed-size loads, which identifies
+  // symbols of up to 16 characters exactly, and the table is open addressed
+  // with Fibonacci hashing.
+  size_t columnFor(const string &symbol) {
+    SymbolKey key = keyOf(symbol);
+    size_t mask = m_slots.size() - 1;
+    for (size_t i = homeSlot(key);; i = (i + 1) & mask) {
+      const ColumnSlot &slot = m_slots[i];
+      if (slot.column < 0)
+        return addColumn(symbol, key, i);
+      if (slot.key.head == key.head && slot.key.tail == key.tail &&
+          slot.key.len == key.len &&
+          (key.len <= 16 || m_columns[slot.column].entry->first == symbol))
+        return static_cast<size_t>(slot.column);
+    }
+  }
+
+  // Overlapping loads cover every byte of a short symbol; lengths 4-7 share
+  // one path so mixed-length names (EURUSD, US30, DE40) do not mispredict.
+  static SymbolKey keyOf(const string &symbol) {
+    SymbolKey key{0, 0, symbol.size()};
+    const char *d = symbol.data();
+    size_t len = key.len;
+    if (len >= 8) {
+      memcpy(&key.head, d, 8);
+      memcpy(&key.tail, d + len - 8, 8);
+    } else if (len >= 4) {
+      uint32_t first, last;
+      memcpy(&first, d, 4);
+      memcpy(&last, d + len - 4, 4);
+      key.head = first | static_cast<uint64_t>(last) << 32;
+    } else if (len > 0) {
+      key.head = static_cast<uint8_t>(d[0]) |
+                 static_cast<uint64_t>(static_cast<uint8_t>(d[len / 2])) << 8 |
+                 static_cast<uint64_t>(static_cast<uint8_t>(d[len - 1])) << 16;
+    }
+    return key;
+  }
+
+  size_t homeSlot(const SymbolKey &key) const {
+    uint64_t hash =
+        (key.head ^ (key.tail * 31) ^ key.len) * 0x9e3779b97f4a7c15ULL;
+    return hash >> m_slotShift;
+  }
+
+  size_t addColumn(const string &symbol, const SymbolKey &key, size_t slot) {
+    size_t c = m_columns.size();
+    m_columns.push_back(SymbolColumns{&*barsFor(symbol), {}, {}, {}});
+    m_slots[slot] = ColumnSlot{key, static_cast<int32_t>(c)};
+    // Keep the table at most half full
+    if (2 * m_columns.size() > m_slots.size()) {
+      vector<ColumnSlot> old(2 * m_slots.size(), ColumnSlot{});
+      old.swap(m_slots);
+      --m_slotShift;
+      size_t mask = m_slots.size() - 1;
+      for (const ColumnSlot &entry : old) {
+        if (entry.column < 0)
+          continue;
+        size_t i = homeSlot(entry.key);
+        while (m_slots[i].column >= 0)
+          i = (i + 1) & mask;
+        m_slots[i] = entry;
+      }
+    }
+    return c;
+  }
+
+  void foldTick(const string &symbol, FixedPrice price, long volume,
+                long long epoch) {
+    auto it = barsFor(symbol);
+    foldRun(it->first, it->second, epoch, &price, &volume, 1);
+    if (!m_batching)
+      flushCsvOutputs();
+  }
+
+  void advanceLocked(long long epochSeconds) {
+    m_wheel.advance(epochSeconds, [this](int64_t, const BarTimer &t) {
+      closeExpired(t);
+    });
+  }
+
+  void closeExpired(const BarTimer &t) {
+    int64_t seconds = m_timeframes[t.tfIndex].seconds;
+    int64_t bucketEnd = t.bucketStart + seconds;
+    OHLCBar &bar = *t.bar;
+    // A tick for a later bucket got here first and already closed it
+    if (bar.timestamp != chrono::system_clock::from_time_t(t.bucketStart))
+      return;
+
+    // An empty bar here is a carried-forward placeholder
+    saveToCSV(*t.symbol, t.tfIndex, bar);
+    if (m_emitEmptyBars) {
+      FixedPrice last = bar.close;
+      bar = OHLCBar();
+      bar.timestamp = chrono::system_clock::from_time_t(bucketEnd);
+      bar.open = bar.high = bar.low = bar.close = last;
+      m_wheel.schedule(bucketEnd + seconds,
+                       BarTimer{t.symbol, t.tfIndex, t.bar, bucketEnd});
+    } else {
+      bar = OHLCBar();
+    }
+    if (m_shm)
+      publishBar(*t.symbol, t.tfIndex, bar);
+  }
+
+  // Folds a run of ticks from the same second into the bar of every
+  // timeframe. Buckets are whole seconds, so the run is in one bucket per
+  // timeframe and is summarised once; the min/max/sum loop runs over
+  // contiguous integer columns so the compiler can vectorize it.
+  void foldRun(const string &symbol, vector<OHLCBar> &bars, long long epoch,
+               const FixedPrice *prices, const long *volumes, size_t n) {
+    RunSummary run{prices[0], prices[0], prices[0], prices[n - 1], 0,
+                   static_cast<int>(n)};
+    for (size_t k = 0; k < n; ++k) {
+      run.high = prices[k] > run.high ? prices[k] : run.high;
+      run.low = prices[k] < run.low ? prices[k] : run.low;
+      run.volume += volumes[k];
+    }
+    const long long *buckets = bucketsOf(epoch);
+    for (size_t t = 0; t < m_timeframes.size(); ++t)
+      foldSummary(symbol, t, bars[t], buckets[t], run);
+  }
+
+  // Adds a run in `bucket` to `bar`, closing the previous bar first if it
+  // belongs to another bucket.
+  void foldSummary(const string &symbol, size_t tfIndex, OHLCBar &bar,
+                   long long bucket, const RunSummary &run) {
+    int64_t seconds = m_timeframes[tfIndex].seconds;
+    auto bucket_tp = chrono::system_clock::from_time_t(bucket);
+
+    // The tick beat the timer to the boundary: close here, including the
+    // flat bars of any quiet buckets in between when those are enabled.
+    // Placeholders (empty bars with a timestamp) only exist in that mode.
+    if (bar.timestamp != bucket_tp &&
+        bar.timestamp != chrono::system_clock::time_point()) {
+      long long barStart = chrono::duration_cast<chrono::seconds>(
+                               bar.timestamp.time_since_epoch())
+                               .count();
+      long long gap = (bucket - barStart) / seconds - 1;
+      saveToCSV(symbol, tfIndex, bar,
+                m_emitEmptyBars && gap > 0 ? static_cast<size_t>(gap) : 0);
+      bar = OHLCBar(); // Reset
+    }
+
+    if (bar.isEmpty()) {
+      // A placeholder for this bucket already has its timer
+      if (bar.timestamp != bucket_tp) {
+        m_wheel.schedule(bucket + seconds,
+                         BarTimer{&symbol, tfIndex, &bar, bucket});
+      }
+      bar.timestamp = bucket_tp;
+      bar.open = bar.high = bar.low = run.open;
+    }
+    if (run.high > bar.high)
+      bar.high = run.high;
+    if (run.low < bar.low)
+      bar.low = run.low;
+    bar.close = run.close;
+    bar.volume += run.volume;
+    bar.tick_count += run.ticks;
+
+    if (m_shm)
+      publishBar(symbol, tfIndex, bar);
+  }
+
+  void publishBar(const string &symbol, size_t tfIndex, const OHLCBar &bar) {
+    auto it = m_shmSlots.find(symbol);
+    if (it == m_shmSlots.end()) {
+      ShmSlot slot;
+      slot.index =
+          m_shm->slotFor(m_venue.empty() ? symbol : m_venue + "/" + symbol);
+      slot.scale = PriceScales::forSymbol(symbol);
+      it = m_shmSlots.emplace(symbol, slot).first;
+    }
+    if (it->second.index)
+      m_shm->publishBar(*it->second.index, tfIndex, bar, it->second.scale);
+  }
+
+  // Queues `bar`, followed by `flatBars` empty bars for the next buckets at
+  // the bar's close price, for its file. Callers flush with
+  // flushCsvOutputs() once they are done (per tick live, per batch for
+  // onPrices).
+  void saveToCSV(const string &symbol, size_t tfIndex, const OHLCBar &bar,
+                 size_t flatBars = 0) {
+    const Timeframe &tf = m_timeframes[tfIndex];
+    auto &outputs = m_csvOutputs[symbol];
+    if (outputs.empty())
+      outputs.resize(m_timeframes.size());
+    CsvOutput &out = outputs[tfIndex];
+    if (!out.checked) {
+      out.path = m_dataDir + "/" + symbol + "_" + tf.name + ".csv";
+      out.scale = PriceScales::forSymbol(symbol);
+      error_code ec;
+      out.hasHeader = fs::file_size(out.path, ec) > 0 && !ec;
+      out.checked = true;
+    }
+    if (out.pending.empty())
+      m_dirtyCsv.push_back(&out);
+    if (!out.hasHeader) {
+      out.pending.append(CsvWriter<OHLCBar>::header);
+      out.hasHeader = true;
+    }
+    CsvWriter<OHLCBar>::write(out.pending, bar, out.scale);
+    OHLCBar flat;
+    flat.timestamp = bar.timestamp;
+    flat.open = flat.high = flat.low = flat.close = bar.close;
+    for (size_t i = 0; i < flatBars; ++i) {
+      flat.timestamp += chrono::seconds(tf.seconds);
+      CsvWriter<OHLCBar>::write(out.pending, flat, out.scale);
+    }
+  }
+
+  // Appends every queued bar to its file: one open and write per file.
+  void flushCsvOutputs() {
+    for (CsvOutput *out : m_dirtyCsv) {
+      ofstream file(out->path, ios::app);
+      if (file.is_open())
+        file.write(out->pending.data(), out->pending.size());
+      else
+        error("Cannot append to " + out->path);
+      out->pending.clear();
     }
+    m_dirtyCsv.clear();
   }
 
   string m_clientId;
+  string m_venue;
+  string m_dataDir;
   vector<Timeframe> m_timeframes;
-  // Using unordered_map for O(1) average lookup performance
-  unordered_map<string, unordered_map<Timeframe, OHLCBar>> m_bars;
+  bool m_defaultKernel;
+  vector<long long> m_bucketCache;
+  long long m_cachedEpoch = numeric_limits<long long>::min();
+  // Bars per symbol, indexed like m_timeframes
+  BarMap m_bars;
+  unordered_map<string, vector<CsvOutput>> m_csvOutputs;
+  vector<CsvOutput *> m_dirtyCsv;
+  bool m_batching = false;
+  // onPrices staging: columns by symbol, the hash slots indexing them (64
+  // to start, always a power of two) and the columns filled by this batch
+  vector<SymbolColumns> m_columns;
+  vector<ColumnSlot> m_slots = vector<ColumnSlot>(64);
+  int m_slotShift = 64 - 6;
+  vector<size_t> m_touched;
+  struct ShmSlot {
+    optional<uint32_t> index;
+    PriceScale scale;
+  };
+  SharedMarketDataPublisher *m_shm = nullptr;
+  unordered_map<string, ShmSlot> m_shmSlots;
+  TimingWheel<BarTimer> m_wheel;
+  BarCloseMode m_closeMode = BarCloseMode::WallClock;
+  bool m_emitEmptyBars = false;
   mutex m_mutex;
 };
@@ -0,0 +1,126 @@
+#pragma once
+
+#include <bits/stdc++.h>
+#include <ixwebsocket/IXWebSocketServer.h>
+
+#include "../Logger.h"
+#include "ConsolidatedBook.h"
+#include "MessageWriter.h"
+
+using namespace std;
+using namespace Logger;
+
+// WebSocket side of the client: keeps the consolidated book and pushes it
+// to every connected browser once per publish interval. A new client gets a
+// JSON snapshot straight away and can switch to the binary layout by
+// sending {"encoding":"binary"}.
+class QuoteFeedServer {
+public:
+  QuoteFeedServer(int port, const string &host = "0.0.0.0")
+      : m_port(port), m_server(port, host) {
+    m_server.setOnClientMessageCallback(
+        [this](shared_ptr<ix::ConnectionState> connectionState,
+               ix::WebSocket &webSocket, const ix::WebSocketMessagePtr &msg) {
+          onClientMessage(webSocket, msg);
+        });
+  }
+
+  ~QuoteFeedServer() { stop(); }
+
+  bool start() {
+    auto res = m_server.listen();
+    if (!res.first) {
+      error("WebSocket server failed to start on port " + to_string(m_port) +
+            ": " + res.second);
+      return false;
+    }
+    m_server.start();
+    m_started = true;
+    info("WebSocket server started on port " + to_string(m_port));
+    return true;
+  }
+
+  void stop() {
+    if (m_started) {
+      m_server.stop();
+      m_started = false;
+    }
+  }
+
+  void apply(const WSMessage &msg) {
+    lock_guard<mutex> lock(m_mutex);
+    m_book.apply(msg);
+  }
+
+  // Sends the current book to every client.
+  void publish(chrono::system_clock::time_point now) {
+    lock_guard<mutex> lock(m_mutex);
+    if (m_book.empty())
+      return;
+    // Each encoding is serialized at most once per interval and the same
+    // frame is sent to every client that asked for it.
+    auto ts =
+        chrono::duration_cast<chrono::seconds>(now.time_since_epoch()).count();
+    m_jsonFrame.clear();
+    m_binaryFrame.clear();
+    for (auto &&client : m_server.getClients()) {
+      auto it = m_encodings.find(client.get());
+      if (it != m_encodings.end() && it->second == Encoding::Binary) {
+        if (m_binaryFrame.empty())
+          writeBook(m_binaryFrame, Encoding::Binary, m_book, ts);
+        client->sendBinary(m_binaryFrame.str());
+      } else {
+        if (m_jsonFrame.empty())
+          writeBook(m_jsonFrame, Encoding::Json, m_book, ts);
+        client->send(m_jsonFrame.str());
+      }
+    }
+  }
+
+private:
+  void onClientMessage(ix::WebSocket &webSocket,
+                       const ix::WebSocketMessagePtr &msg) {
+    thread_local MessageBuffer snapshot;
+    auto sendSnapshot = [&](Encoding encoding) {
+      auto ts = chrono::duration_cast<chrono::seconds>(
+                    chrono::system_clock::now().time_since_epoch())
+                    .count();
+      writeBook(snapshot, encoding, m_book, ts);
+      if (encoding == Encoding::Binary)
+        webSocket.sendBinary(snapshot.str());
+      else
+        webSocket.send(snapshot.str());
+    };
+
+    if (msg->type == ix::WebSocketMessageType::Open) {
+      lock_guard<mutex> lock(m_mutex);
+      m_encodings[&webSocket] = Encoding::Json;
+      sendSnapshot(Encoding::Json);
+    } else if (msg->type == ix::WebSocketMessageType::Close) {
+      lock_guard<mutex> lock(m_mutex);
+      m_encodings.erase(&webSocket);
+    } else if (msg->type == ix::WebSocketMessageType::Message) {
+      auto request = parseEncodingRequest(msg->str);
+      if (!request) {
+        warn("WebSocket client sent an unknown request; expected "
+             "{\"encoding\":\"json\"} or {\"encoding\":\"binary\"}");
+        return;
+      }
+      Encoding encoding = *request;
+      lock_guard<mutex> lock(m_mutex);
+      m_encodings[&webSocket] = encoding;
+      sendSnapshot(encoding);
+      info("WebSocket client switched to " +
+           string(encoding == Encoding::Binary ? "binary" : "json") +
+           " encoding");
+    }
+  }
+
+  int m_port;
+  ix::WebSocketServer m_server;
+  bool m_started = false;
+  ConsolidatedBook m_book;
+  unordered_map<ix::WebSocket *, Encoding> m_encodings;
+  MessageBuffer m_jsonFrame, m_binaryFrame;
+  mutex m_mutex;
+};
@@ -0,0 +1,353 @@
+#pragma once
+
+// Shared-memory layout for co-located consumers of MarketDataClient, plus the
+// reader side. Consumers only need this header.
+//
+// Region layout:
+//   ShmHeader | ShmDirectoryEntry[maxKeys] | ShmQuoteSlot[maxKeys]
+//             | ShmBarSlot[maxKeys * timeframeCount]
+//
+// Every slot is guarded by a seqlock: the single writer makes the sequence
+// odd, writes the fields and makes it even again. Readers retry while the
+// sequence is odd or changed under them, so a read never blocks the writer
+// and never enters the kernel.
+
+#include <bits/stdc++.h>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+using namespace std;
+
+static_assert(atomic<int64_t>::is_always_lock_free,
+              "Shared-memory slots need lock-free 64-bit atomics");
+
+constexpr uint32_t kShmMagic = 0x4D444331; // "MDC1"
+constexpr uint32_t kShmVersion = 1;
+constexpr size_t kShmMaxTimeframes = 32;
+constexpr size_t kShmKeySize = 32;
+// Bid or ask of a quote whose side is missing (e.g. only an offer has been
+// seen for the symbol, or a venue withdrew it).
+constexpr int64_t kShmNoPrice = numeric_limits<int64_t>::min();
+
+struct ShmHeader {
+  uint32_t magic;
+  uint32_t version;
+  uint32_t maxKeys;
+  uint32_t timeframeCount;
+  int64_t timeframeSeconds[kShmMaxTimeframes];
+  // Published with release after the directory entry is filled in
+  atomic<uint32_t> keyCount;
+};
+
+// A symbol, or "<venue>/<symbol>" for per-venue bars.
+struct ShmDirectoryEntry {
+  char key[kShmKeySize];
+};
+
+struct alignas(64) ShmQuoteSlot {
+  atomic<uint32_t> seq;
+  atomic<int32_t> decimals;
+  atomic<int64_t> bid;
+  atomic<int64_t> ask;
+  atomic<int64_t> timestampNs;
+};
+
+struct alignas(64) ShmBarSlot {
+  atomic<uint32_t> seq;
+  atomic<int32_t> decimals;
+  atomic<int64_t> bucketStart;
+  atomic<int64_t> open;
+  atomic<int64_t> high;
+  atomic<int64_t> low;
+  atomic<int64_t> close;
+  atomic<int64_t> volume;
+  atomic<int64_t> tickCount;
+};
+
+// Plain copies handed to readers. Prices are integer increments; divide by
+// 10^decimals for the decimal quote. A quote's bid or ask is kShmNoPrice
+// when that side is missing.
+struct ShmQuote {
+  int32_t decimals = 0;
+  int64_t bid = 0;
+  int64_t ask = 0;
+  int64_t timestampNs = 0;
+};
+
+struct ShmBar {
+  int32_t decimals = 0;
+  int64_t bucketStart = 0;
+  int64_t open = 0, high = 0, low = 0, close = 0;
+  int64_t volume = 0;
+  int64_t tickCount = 0;
+};
+
+inline uint64_t shmRegionSize(uint32_t maxKeys, uint32_t timeframeCount) {
+  uint64_t header = (sizeof(ShmHeader) + 63) / 64 * 64;
+  uint64_t directory =
+      (sizeof(ShmDirectoryEntry) * uint64_t(maxKeys) + 63) / 64 * 64;
+  return header + directory + sizeof(ShmQuoteSlot) * uint64_t(maxKeys) +
+         sizeof(ShmBarSlot) * uint64_t(maxKeys) * timeframeCount;
+}
+
+// Seqlock write section. Only one thread may write a given slot.
+template <typename Slot, typename Fn> void seqlockWrite(Slot &slot, Fn fn) {
+  uint32_t seq = slot.seq.load(memory_order_relaxed);
+  slot.seq.store(seq + 1, memory_order_relaxed);
+  atomic_thread_fence(memory_order_release);
+  fn(slot);
+  slot.seq.store(seq + 2, memory_order_release);
+}
+
+// Seqlock read section; retries until it gets a consistent copy.
+template <typename Slot, typename Fn>
+void seqlockRead(const Slot &slot, Fn fn) {
+  for (;;) {
+    uint32_t before = slot.seq.load(memory_order_acquire);
+    if (before & 1)
+      continue;
+    fn(slot);
+    atomic_thread_fence(memory_order_acquire);
+    if (slot.seq.load(memory_order_relaxed) == before)
+      return;
+  }
+}
+
+// Named shared-memory mapping (POSIX shm_open / Win32 file mapping).
+class SharedMemoryRegion {
+public:
+  // Creates a new, zero-filled region. Fails if `name` already exists, so
+  // two writers never share a region; a region left behind by a crashed
+  // writer has to be removed first (/dev/shm/<name> on Linux).
+  static SharedMemoryRegion create(const string &name, size_t size) {
+    SharedMemoryRegion region;
+    region.m_name = name;
+    region.m_size = size;
+    region.m_owner = true;
+#ifdef _WIN32
+    region.m_handle =
+        CreateFileMappingA(INVALID_HANDLE_VALUE, NULL, PAGE_READWRITE,
+                           static_cast<DWORD>(uint64_t(size) >> 32),
+                           static_cast<DWORD>(size & 0xFFFFFFFF),
+                           ("Local\\" + name).c_str());
+    if (!region.m_handle)
+      throw runtime_error("CreateFileMapping failed for " + name);
+    if (GetLastError() == ERROR_ALREADY_EXISTS) {
+      CloseHandle(region.m_handle);
+      throw runtime_error("Shared memory " + name + " already exists");
+    }
+    region.m_base = MapViewOfFile(region.m_handle, FILE_MAP_ALL_ACCESS, 0, 0,
+                                  size);
+#else
+    int fd = shm_open(("/" + name).c_str(), O_CREAT | O_EXCL | O_RDWR, 0644);
+    if (fd < 0 && errno == EEXIST)
+      throw runtime_error("Shared memory " + name + " already exists");
+    if (fd < 0)
+      throw runtime_error("shm_open failed for " + name);
+    if (ftruncate(fd, static_cast<off_t>(size)) != 0) {
+      close(fd);
+      shm_unlink(("/" + name).c_str());
+      throw runtime_error("ftruncate failed for " + name);
+    }
+    region.m_base =
+        mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (region.m_base == MAP_FAILED) {
+      region.m_base = nullptr;
+      shm_unlink(("/" + name).c_str());
+    }
+#endif
+    if (!region.m_base)
+      throw runtime_error("Mapping shared memory failed for " + name);
+    return region;
+  }
+
+  static SharedMemoryRegion open(const string &name) {
+    SharedMemoryRegion region;
+    region.m_name = name;
+#ifdef _WIN32
+    region.m_handle =
+        OpenFileMappingA(FILE_MAP_READ, FALSE, ("Local\\" + name).c_str());
+    if (!region.m_handle)
+      throw runtime_error("Shared memory " + name + " not found");
+    region.m_base = MapViewOfFile(region.m_handle, FILE_MAP_READ, 0, 0, 0);
+    MEMORY_BASIC_INFORMATION info;
+    if (region.m_base && VirtualQuery(region.m_base, &info, sizeof(info)))
+      region.m_size = info.RegionSize;
+#else
+    int fd = shm_open(("/" + name).c_str(), O_RDONLY, 0);
+    if (fd < 0)
+      throw runtime_error("Shared memory " + name + " not found");
+    off_t size = lseek(fd, 0, SEEK_END);
+    region.m_size = size > 0 ? static_cast<size_t>(size) : 0;
+    region.m_base = region.m_size
+                        ? mmap(nullptr, region.m_size, PROT_READ, MAP_SHARED,
+                               fd, 0)
+                        : nullptr;
+    close(fd);
+    if (region.m_base == MAP_FAILED)
+      region.m_base = nullptr;
+#endif
+    if (!region.m_base)
+      throw runtime_error("Mapping shared memory failed for " + name);
+    return region;
+  }
+
+  SharedMemoryRegion() = default;
+  SharedMemoryRegion(const SharedMemoryRegion &) = delete;
+  SharedMemoryRegion &operator=(const SharedMemoryRegion &) = delete;
+  SharedMemoryRegion(SharedMemoryRegion &&other) noexcept { swap(other); }
+  SharedMemoryRegion &operator=(SharedMemoryRegion &&other) noexcept {
+    swap(other);
+    return *this;
+  }
+  ~SharedMemoryRegion() { release(); }
+
+  void *data() const { return m_base; }
+  size_t size() const { return m_size; }
+
+private:
+  void swap(SharedMemoryRegion &other) noexcept {
+    std::swap(m_name, other.m_name);
+    std::swap(m_base, other.m_base);
+    std::swap(m_size, other.m_size);
+    std::swap(m_owner, other.m_owner);
+#ifdef _WIN32
+    std::swap(m_handle, other.m_handle);
+#endif
+  }
+
+  void release() {
+    if (!m_base)
+      return;
+#ifdef _WIN32
+    UnmapViewOfFile(m_base);
+    CloseHandle(m_handle);
+#else
+    munmap(m_base, m_size);
+    if (m_owner)
+      shm_unlink(("/" + m_name).c_str());
+#endif
+    m_base = nullptr;
+  }
+
+  string m_name;
+  void *m_base = nullptr;
+  size_t m_size = 0;
+  bool m_owner = false;
+#ifdef _WIN32
+  HANDLE m_handle = NULL;
+#endif
+};
+
+// Typed view over a mapped region, shared by the publisher and the reader.
+struct ShmView {
+  ShmHeader *header = nullptr;
+  ShmDirectoryEntry *directory = nullptr;
+  ShmQuoteSlot *quotes = nullptr;
+  ShmBarSlot *bars = nullptr;
+
+  static ShmView over(void *base, uint32_t maxKeys) {
+    char *p = static_cast<char *>(base);
+    ShmView view;
+    view.header = reinterpret_cast<ShmHeader *>(p);
+    p += (sizeof(ShmHeader) + 63) / 64 * 64;
+    view.directory = reinterpret_cast<ShmDirectoryEntry *>(p);
+    p += (sizeof(ShmDirectoryEntry) * maxKeys + 63) / 64 * 64;
+    view.quotes = reinterpret_cast<ShmQuoteSlot *>(p);
+    p += sizeof(ShmQuoteSlot) * maxKeys;
+    view.bars = reinterpret_cast<ShmBarSlot *>(p);
+    return view;
+  }
+
+  ShmBarSlot &bar(uint32_t key, size_t tfIndex) const {
+    return bars[size_t(key) * header->timeframeCount + tfIndex];
+  }
+};
+
+// Lock-free reader for consumers on the same host. Look a key up once with
+// findKey() and keep the index; reads are then plain loads from the mapping.
+class SharedMarketDataReader {
+public:
+  explicit SharedMarketDataReader(const string &name)
+      : m_region(SharedMemoryRegion::open(name)) {
+    auto *header = static_cast<ShmHeader *>(m_region.data());
+    if (m_region.size() < sizeof(ShmHeader) || header->magic != kShmMagic ||
+        header->version != kShmVersion) {
+      throw runtime_error("Shared memory " + name +
+                          " is not a MarketDataClient region");
+    }
+    // The header is written once before magic; copy the dimensions so every
+    // later index is checked against what was mapped
+    m_maxKeys = header->maxKeys;
+    m_timeframeCount = header->timeframeCount;
+    if (m_timeframeCount > kShmMaxTimeframes ||
+        m_region.size() < shmRegionSize(m_maxKeys, m_timeframeCount)) {
+      throw runtime_error("Shared memory " + name +
+                          " is smaller than its header describes");
+    }
+    m_view = ShmView::over(m_region.data(), m_maxKeys);
+  }
+
+  optional<uint32_t> findKey(const string &key) const {
+    uint32_t count =
+        min(m_view.header->keyCount.load(memory_order_acquire), m_maxKeys);
+    for (uint32_t i = 0; i < count; ++i) {
+      if (strncmp(m_view.directory[i].key, key.c_str(), kShmKeySize) == 0)
+        return i;
+    }
+    return nullopt;
+  }
+
+  vector<int64_t> timeframes() const {
+    return vector<int64_t>(m_view.header->timeframeSeconds,
+                           m_view.header->timeframeSeconds +
+                               m_timeframeCount);
+  }
+
+  // False until the writer has published a quote for this key, or if the
+  // key is out of range. A missing side reads as kShmNoPrice.
+  bool readQuote(uint32_t key, ShmQuote &out) const {
+    if (key >= m_maxKeys)
+      return false;
+    seqlockRead(m_view.quotes[key], [&out](const ShmQuoteSlot &s) {
+      out.decimals = s.decimals.load(memory_order_relaxed);
+      out.bid = s.bid.load(memory_order_relaxed);
+      out.ask = s.ask.load(memory_order_relaxed);
+      out.timestampNs = s.timestampNs.load(memory_order_relaxed);
+    });
+    return out.timestampNs != 0;
+  }
+
+  // False until a bar has been opened for this key and timeframe.
+  bool readBar(uint32_t key, size_t tfIndex, ShmBar &out) const {
+    if (key >= m_maxKeys || tfIndex >= m_timeframeCount)
+      return false;
+    seqlockRead(m_view.bar(key, tfIndex), [&out](const ShmBarSlot &s) {
+      out.decimals = s.decimals.load(memory_order_relaxed);
+      out.bucketStart = s.bucketStart.load(memory_order_relaxed);
+      out.open = s.open.load(memory_order_relaxed);
+      out.high = s.high.load(memory_order_relaxed);
+      out.low = s.low.load(memory_order_relaxed);
+      out.close = s.close.load(memory_order_relaxed);
+      out.volume = s.volume.load(memory_order_relaxed);
+      out.tickCount = s.tickCount.load(memory_order_relaxed);
+    });
+    return out.tickCount != 0;
+  }
+
+private:
+  SharedMemoryRegion m_region;
+  ShmView m_view;
+  uint32_t m_maxKeys = 0;
+  uint32_t m_timeframeCount = 0;
+};
@@ -0,0 +1,103 @@
+#pragma once
+
+#include "../Logger.h"
+#include "MarketDataTypes.h"
+#include "SharedMarketData.h"
+#include <bits/stdc++.h>
+
+using namespace std;
+using namespace Logger;
+
+static_assert(kShmNoPrice == kNoPrice,
+              "Readers see a missing side as kShmNoPrice");
+
+// Writer side of SharedMarketData.h. Each key (symbol, or venue/symbol for
+// per-venue bars) gets a directory index on first use; after that publishing
+// is a seqlock write into a fixed slot. Each slot must have a single writer:
+// quotes come from the FIX thread, bars from the aggregator owning the key.
+class SharedMarketDataPublisher {
+public:
+  SharedMarketDataPublisher(const string &name, uint32_t maxKeys,
+                            const vector<int64_t> &timeframeSeconds)
+      : m_maxKeys(maxKeys) {
+    if (timeframeSeconds.size() > kShmMaxTimeframes) {
+      throw runtime_error("Too many timeframes for shared memory: " +
+                          to_string(timeframeSeconds.size()));
+    }
+    uint32_t tfCount = static_cast<uint32_t>(timeframeSeconds.size());
+    m_region =
+        SharedMemoryRegion::create(name, shmRegionSize(maxKeys, tfCount));
+    m_view = ShmView::over(m_region.data(), maxKeys);
+
+    ShmHeader *header = m_view.header;
+    header->maxKeys = maxKeys;
+    header->timeframeCount = tfCount;
+    copy(timeframeSeconds.begin(), timeframeSeconds.end(),
+         header->timeframeSeconds);
+    header->version = kShmVersion;
+    header->keyCount.store(0, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+    header->magic = kShmMagic;
+
+    info("Shared memory '" + name + "' ready: " + to_string(maxKeys) +
+         " keys, " + to_string(tfCount) + " timeframes, " +
+         to_string(m_region.size()) + " bytes");
+  }
+
+  // Directory index for `key`, registering it if needed. Returns nullopt
+  // when the region is full or the key is too long.
+  optional<uint32_t> slotFor(const string &key) {
+    lock_guard<mutex> lock(m_mutex);
+    auto it = m_slots.find(key);
+    if (it != m_slots.end())
+      return it->second;
+
+    uint32_t index = m_view.header->keyCount.load(memory_order_relaxed);
+    if (index >= m_maxKeys || key.size() >= kShmKeySize) {
+      warn("Shared memory: cannot publish key " + key);
+      return nullopt;
+    }
+    strncpy(m_view.directory[index].key, key.c_str(), kShmKeySize - 1);
+    m_view.header->keyCount.store(index + 1, memory_order_release);
+    m_slots[key] = index;
+    return index;
+  }
+
+  void publishQuote(uint32_t slot, const WSMessage &q) {
+    int64_t nowNs = chrono::duration_cast<chrono::nanoseconds>(
+                        chrono::system_clock::now().time_since_epoch())
+                        .count();
+    seqlockWrite(m_view.quotes[slot], [&](ShmQuoteSlot &s) {
+      s.decimals.store(q.scale.decimals, memory_order_relaxed);
+      s.bid.store(q.bid, memory_order_relaxed);
+      s.ask.store(q.ask, memory_order_relaxed);
+      s.timestampNs.store(nowNs, memory_order_relaxed);
+    });
+  }
+
+  void publishBar(uint32_t slot, size_t tfIndex, const OHLCBar &bar,
+                  const PriceScale &scale) {
+    if (tfIndex >= m_view.header->timeframeCount)
+      return;
+    int64_t bucketStart = chrono::duration_cast<chrono::seconds>(
+                              bar.timestamp.time_since_epoch())
+                              .count();
+    seqlockWrite(m_view.bar(slot, tfIndex), [&](ShmBarSlot &s) {
+      s.decimals.store(scale.decimals, memory_order_relaxed);
+      s.bucketStart.store(bucketStart, memory_order_relaxed);
+      s.open.store(bar.open, memory_order_relaxed);
+      s.high.store(bar.high, memory_order_relaxed);
+      s.low.store(bar.low, memory_order_relaxed);
+      s.close.store(bar.close, memory_order_relaxed);
+      s.volume.store(bar.volume, memory_order_relaxed);
+      s.tickCount.store(bar.tick_count, memory_order_relaxed);
+    });
+  }
+
+private:
+  uint32_t m_maxKeys;
+  SharedMemoryRegion m_region;
+  ShmView m_view;
+  unordered_map<string, uint32_t> m_slots;
+  mutex m_mutex;
+};
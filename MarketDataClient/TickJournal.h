@@ -0,0 +1,294 @@
+#pragma once
+
+#include "../Logger.h"
+#include <bits/stdc++.h>
+#include <zlib.h>
+
+using namespace std;
+using namespace Logger;
+namespace fs = filesystem;
+
+// Append-only binary capture of every decoded tick.
+//
+// The ingest thread copies a fixed-size record into a lock-free
+// single-producer ring and returns; a dedicated writer thread batches the
+// records into blocks, deflates each block with zlib and appends it to one
+// journal file per UTC day (<dir>/<YYYYMMDD>.tj). Every block also gets an
+// entry in <dir>/<YYYYMMDD>.idx, so a time range can be read back by
+// inflating only the blocks that overlap it. Symbol ids are listed in
+// <dir>/symbols.csv as "id,venue,symbol".
+
+enum class JournalTickType : uint8_t { Trade = 0, Bid = 1, Offer = 2 };
+
+#pragma pack(push, 1)
+struct JournalRecord {
+  uint32_t symbolId;
+  JournalTickType type;
+  uint8_t decimals;
+  uint16_t reserved;
+  int64_t price; // in increments of 10^-decimals
+  int64_t size;
+  int64_t eventTimeNs;   // FIX SendingTime
+  int64_t receiveTimeNs; // local clock when the message was cracked
+};
+
+struct JournalBlockHeader {
+  uint32_t magic;
+  uint32_t recordCount;
+  uint32_t rawSize;
+  uint32_t compressedSize;
+};
+
+struct JournalIndexEntry {
+  int64_t firstReceiveNs;
+  int64_t lastReceiveNs;
+  uint64_t offset; // of the JournalBlockHeader in the .tj file
+  uint32_t recordCount;
+  uint32_t compressedSize;
+};
+#pragma pack(pop)
+
+constexpr uint32_t kJournalBlockMagic = 0x314A5454; // "TTJ1"
+
+class TickJournal {
+public:
+  // ringCapacity is rounded up to a power of two. Records that do not fit
+  // because the writer fell behind are dropped and counted, never waited on;
+  // so are the records of a block that fails to compress.
+  TickJournal(const string &dir, size_t ringCapacity = 1 << 16,
+              size_t blockRecords = 8192, int compressionLevel = 1)
+      : m_dir(dir), m_blockRecords(blockRecords),
+        m_compressionLevel(compressionLevel) {
+    size_t capacity = 1;
+    while (capacity < ringCapacity)
+      capacity <<= 1;
+    m_ring.resize(capacity);
+    m_mask = capacity - 1;
+
+    if (!fs::exists(m_dir))
+      fs::create_directories(m_dir);
+    loadSymbols();
+
+    m_block.reserve(m_blockRecords);
+    m_writer = thread([this]() { writerLoop(); });
+    info("Tick journal writing to " + m_dir);
+  }
+
+  ~TickJournal() {
+    m_running = false;
+    if (m_writer.joinable())
+      m_writer.join();
+    if (m_dropped.load() > 0)
+      warn("Tick journal dropped " + to_string(m_dropped.load()) +
+           " records (writer fell behind or a block failed to compress)");
+  }
+
+  // Stable id for (venue, symbol). Call once per new symbol and cache the
+  // result; it takes a lock and may write to symbols.csv.
+  uint32_t registerSymbol(const string &venue, const string &symbol) {
+    lock_guard<mutex> lock(m_symbolMutex);
+    auto key = make_pair(venue, symbol);
+    auto it = m_symbolIds.find(key);
+    if (it != m_symbolIds.end())
+      return it->second;
+    uint32_t id = static_cast<uint32_t>(m_symbolIds.size());
+    m_symbolIds[key] = id;
+    ofstream file(m_dir + "/symbols.csv", ios::app);
+    file << id << "," << venue << "," << symbol << "\n";
+    return id;
+  }
+
+  // Single producer only (the initiator thread).
+  void append(const JournalRecord &record) {
+    size_t head = m_head.load(memory_order_relaxed);
+    if (head - m_tailCache > m_mask) {
+      m_tailCache = m_tail.load(memory_order_acquire);
+      if (head - m_tailCache > m_mask) {
+        m_dropped.fetch_add(1, memory_order_relaxed);
+        return;
+      }
+    }
+    m_ring[head & m_mask] = record;
+    m_head.store(head + 1, memory_order_release);
+  }
+
+  uint64_t dropped() const { return m_dropped.load(); }
+
+private:
+  void loadSymbols() {
+    ifstream file(m_dir + "/symbols.csv");
+    string line;
+    while (getline(file, line)) {
+      size_t a = line.find(','), b = line.rfind(',');
+      if (a == string::npos || a == b)
+        continue;
+      m_symbolIds[{line.substr(a + 1, b - a - 1), line.substr(b + 1)}] =
+          static_cast<uint32_t>(stoul(line.substr(0, a)));
+    }
+  }
+
+  void writerLoop() {
+    auto lastFlush = chrono::steady_clock::now();
+    while (true) {
+      bool running = m_running.load();
+      size_t tail = m_tail.load(memory_order_relaxed);
+      size_t head = m_head.load(memory_order_acquire);
+      while (tail != head) {
+        m_block.push_back(m_ring[tail & m_mask]);
+        ++tail;
+        if (m_block.size() == m_blockRecords) {
+          m_tail.store(tail, memory_order_release);
+          writeBlock();
+        }
+      }
+      m_tail.store(tail, memory_order_release);
+
+      auto now = chrono::steady_clock::now();
+      if (!running || now - lastFlush >= chrono::seconds(1)) {
+        while (!m_block.empty())
+          writeBlock();
+        lastFlush = now;
+      }
+      if (!running)
+        break;
+      this_thread::sleep_for(chrono::milliseconds(5));
+    }
+  }
+
+  static string dayOf(int64_t ns) {
+    time_t t = static_cast<time_t>(ns / 1000000000);
+    tm utc{};
+#ifdef _WIN32
+    gmtime_s(&utc, &t);
+#else
+    gmtime_r(&t, &utc);
+#endif
+    char buf[16];
+    strftime(buf, sizeof(buf), "%Y%m%d", &utc);
+    return buf;
+  }
+
+  void openDay(const string &day) {
+    if (day == m_day && m_data.is_open())
+      return;
+    m_data.close();
+    m_index.close();
+    m_day = day;
+    string base = m_dir + "/" + day;
+    m_data.open(base + ".tj", ios::binary | ios::app);
+    m_index.open(base + ".idx", ios::binary | ios::app);
+    m_offset = fs::exists(base + ".tj") ? fs::file_size(base + ".tj") : 0;
+  }
+
+  void writeBlock() {
+    // A block never spans two days: split at the first record of a new day
+    string day = dayOf(m_block.front().receiveTimeNs);
+    size_t n = 0;
+    while (n < m_block.size() &&
+           (n == 0 || m_block[n].receiveTimeNs / 86400000000000LL ==
+                          m_block[0].receiveTimeNs / 86400000000000LL))
+      ++n;
+
+    uLong rawSize = static_cast<uLong>(n * sizeof(JournalRecord));
+    uLongf compressedSize = compressBound(rawSize);
+    m_compressed.resize(compressedSize);
+    int rc = compress2(m_compressed.data(), &compressedSize,
+                       reinterpret_cast<const Bytef *>(m_block.data()),
+                       rawSize, m_compressionLevel);
+    if (rc != Z_OK) {
+      error("Tick journal: compress2 failed with " + to_string(rc));
+      m_dropped.fetch_add(n, memory_order_relaxed);
+    } else {
+      openDay(day);
+      JournalBlockHeader header{kJournalBlockMagic, static_cast<uint32_t>(n),
+                                static_cast<uint32_t>(rawSize),
+                                static_cast<uint32_t>(compressedSize)};
+      JournalIndexEntry entry{m_block.front().receiveTimeNs,
+                              m_block[n - 1].receiveTimeNs, m_offset,
+                              static_cast<uint32_t>(n),
+                              static_cast<uint32_t>(compressedSize)};
+      m_data.write(reinterpret_cast<const char *>(&header), sizeof(header));
+      m_data.write(reinterpret_cast<const char *>(m_compressed.data()),
+                   compressedSize);
+      m_data.flush();
+      // The index entry goes out after its block so a reader never sees an
+      // entry pointing past the end of the data file
+      m_index.write(reinterpret_cast<const char *>(&entry), sizeof(entry));
+      m_index.flush();
+      m_offset += sizeof(header) + compressedSize;
+    }
+    m_block.erase(m_block.begin(), m_block.begin() + n);
+  }
+
+  string m_dir;
+  size_t m_blockRecords;
+  int m_compressionLevel;
+
+  // SPSC ring; head and tail live on separate cache lines
+  vector<JournalRecord> m_ring;
+  size_t m_mask = 0;
+  alignas(64) atomic<size_t> m_head{0};
+  size_t m_tailCache = 0; // producer's last view of m_tail
+  alignas(64) atomic<size_t> m_tail{0};
+  alignas(64) atomic<uint64_t> m_dropped{0};
+  atomic<bool> m_running{true};
+
+  // Writer thread state
+  vector<JournalRecord> m_block;
+  vector<Bytef> m_compressed;
+  string m_day;
+  ofstream m_data;
+  ofstream m_index;
+  uint64_t m_offset = 0;
+  thread m_writer;
+
+  map<pair<string, string>, uint32_t> m_symbolIds;
+  mutex m_symbolMutex;
+};
+
+// Reads the records of one day's journal whose receive time falls in
+// [fromNs, toNs], inflating only the blocks the index says overlap.
+inline vector<JournalRecord> readJournalRange(const string &journalPath,
+                                              int64_t fromNs, int64_t toNs) {
+  vector<JournalRecord> out;
+  fs::path indexPath = fs::path(journalPath).replace_extension(".idx");
+  ifstream index(indexPath, ios::binary);
+  ifstream data(journalPath, ios::binary);
+  if (!index || !data)
+    throw runtime_error("Cannot open tick journal " + journalPath);
+
+  JournalIndexEntry entry;
+  vector<Bytef> compressed;
+  vector<JournalRecord> block;
+  while (index.read(reinterpret_cast<char *>(&entry), sizeof(entry))) {
+    if (entry.lastReceiveNs < fromNs || entry.firstReceiveNs > toNs)
+      continue;
+    JournalBlockHeader header;
+    data.seekg(static_cast<streamoff>(entry.offset));
+    data.read(reinterpret_cast<char *>(&header), sizeof(header));
+    // rawSize is trusted as the inflate bound only if it matches the count
+    if (!data || header.magic != kJournalBlockMagic ||
+        header.rawSize !=
+            uint64_t(header.recordCount) * sizeof(JournalRecord) ||
+        header.recordCount != entry.recordCount ||
+        header.compressedSize != entry.compressedSize)
+      throw runtime_error("Corrupt tick journal block in " + journalPath);
+    compressed.resize(header.compressedSize);
+    if (!data.read(reinterpret_cast<char *>(compressed.data()),
+                   header.compressedSize))
+      throw runtime_error("Truncated tick journal block in " + journalPath);
+    block.resize(header.recordCount);
+    uLongf rawSize = header.rawSize;
+    if (uncompress(reinterpret_cast<Bytef *>(block.data()), &rawSize,
+                   compressed.data(), header.compressedSize) != Z_OK ||
+        rawSize != header.rawSize) {
+      throw runtime_error("Cannot inflate tick journal block in " +
+                          journalPath);
+    }
+    for (const auto &record : block) {
+      if (record.receiveTimeNs >= fromNs && record.receiveTimeNs <= toNs)
+        out.push_back(record);
+    }
+  }
+  return out;
+}
@@ -0,0 +1,143 @@
+#pragma once
+
+#include <bits/stdc++.h>
+
+using namespace std;
+
+// A bar period. Buckets start at offset + k * seconds (epoch seconds). The
+// offset is zero except for daily and longer bars, which open at the
+// configured session start instead of UTC midnight.
+struct Timeframe {
+  int64_t seconds = 1;
+  int64_t offset = 0;
+  string name; // "2s", "3m", "1d"; used in file names
+
+  long long bucketOf(long long epoch) const {
+    long long shifted = epoch - offset;
+    long long q = shifted / seconds;
+    if (shifted % seconds < 0)
+      --q;
+    return q * seconds + offset;
+  }
+};
+
+// A period fixed at compile time. The division by a constant compiles to a
+// multiply and shift.
+template <int64_t Seconds> struct FixedPeriod {
+  static constexpr int64_t seconds = Seconds;
+
+  static long long bucketOf(long long epoch) {
+    long long q = epoch / Seconds;
+    if (epoch % Seconds < 0)
+      --q;
+    return q * Seconds;
+  }
+};
+
+// Bucket math for a timeframe set known at compile time, unrolled per
+// period.
+template <int64_t... Periods> struct StaticTimeframes {
+  static constexpr size_t count = sizeof...(Periods);
+  static constexpr array<int64_t, count> periods{Periods...};
+
+  // Bucket start of `epoch` for every period, in order.
+  static void bucketsOf(long long epoch, long long *out) {
+    size_t i = 0;
+    ((out[i++] = FixedPeriod<Periods>::bucketOf(epoch)), ...);
+  }
+};
+
+// The set used when client.cfg has no Timeframes entry.
+using DefaultTimeframes =
+    StaticTimeframes<1, 5, 10, 15, 30, 60, 300, 900, 1800, 3600, 14400>;
+
+namespace Timeframes {
+// "2s", "3m", "4h", "1d", or plain seconds.
+inline optional<int64_t> parseSeconds(string_view text) {
+  int64_t value = 0;
+  auto [end, ec] = from_chars(text.data(), text.data() + text.size(), value);
+  if (ec != errc() || value <= 0)
+    return nullopt;
+  string_view unit(end, text.data() + text.size() - end);
+  if (unit.empty() || unit == "s")
+    return value;
+  if (unit == "m")
+    return value * 60;
+  if (unit == "h")
+    return value * 3600;
+  if (unit == "d")
+    return value * 86400;
+  return nullopt;
+}
+
+inline string nameOf(int64_t seconds) {
+  if (seconds % 86400 == 0)
+    return to_string(seconds / 86400) + "d";
+  if (seconds % 3600 == 0)
+    return to_string(seconds / 3600) + "h";
+  if (seconds % 60 == 0)
+    return to_string(seconds / 60) + "m";
+  return to_string(seconds) + "s";
+}
+
+// "HH:MM" (UTC) as seconds after midnight.
+inline int64_t parseSessionStart(const string &text) {
+  int hours = 0, minutes = 0;
+  char sep = 0;
+  stringstream ss(text);
+  if (!(ss >> hours >> sep >> minutes) || sep != ':' || hours < 0 ||
+      hours > 23 || minutes < 0 || minutes > 59)
+    throw invalid_argument("Invalid session start '" + text + "'");
+  return hours * 3600 + minutes * 60;
+}
+
+// sessionStart only applies to periods of a day or longer.
+inline Timeframe make(int64_t seconds, int64_t sessionStart = 0) {
+  Timeframe tf;
+  tf.seconds = seconds;
+  tf.offset = seconds >= 86400 ? sessionStart % seconds : 0;
+  tf.name = nameOf(seconds);
+  return tf;
+}
+
+// Comma-separated list, e.g. "2s,1m,3m,1h,1d".
+inline vector<Timeframe> parseList(const string &list,
+                                   int64_t sessionStart = 0) {
+  vector<Timeframe> timeframes;
+  stringstream ss(list);
+  string item;
+  while (getline(ss, item, ',')) {
+    item.erase(remove(item.begin(), item.end(), ' '), item.end());
+    auto seconds = parseSeconds(item);
+    if (!seconds)
+      throw invalid_argument("Invalid timeframe '" + item + "'");
+    for (const auto &tf : timeframes) {
+      if (tf.seconds == *seconds)
+        throw invalid_argument("Duplicate timeframe '" + item + "'");
+    }
+    timeframes.push_back(make(*seconds, sessionStart));
+  }
+  if (timeframes.empty())
+    throw invalid_argument("No timeframes configured");
+  return timeframes;
+}
+
+inline vector<Timeframe> defaults() {
+  vector<Timeframe> timeframes;
+  for (int64_t seconds : DefaultTimeframes::periods)
+    timeframes.push_back(make(seconds));
+  return timeframes;
+}
+
+// True when `timeframes` can run on the DefaultTimeframes kernel.
+inline bool isDefault(const vector<Timeframe> &timeframes) {
+  if (timeframes.size() != DefaultTimeframes::count)
+    return false;
+  for (size_t i = 0; i < timeframes.size(); ++i) {
+    if (timeframes[i].seconds != DefaultTimeframes::periods[i] ||
+        timeframes[i].offset != 0)
+      return false;
+  }
+  return true;
+}
+} // namespace Timeframes
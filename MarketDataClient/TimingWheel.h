@@ -0,0 +1,131 @@
+#pragma once
+
+#include <bits/stdc++.h>
+
+using namespace std;
+
+// Hierarchical timing wheel with one-second resolution. Level 0 has 256
+// one-second slots; levels 1-3 have 64 slots each covering 2^8, 2^14 and
+// 2^20 seconds. Entries further out than 2^26 seconds wait in an overflow
+// list. advance() visits one slot per elapsed second while entries are near,
+// skips whole empty levels at once, and cascades an upper slot down when the
+// level below wraps, so the work is proportional to the entries that expire
+// rather than to everything scheduled.
+template <typename T> class TimingWheel {
+public:
+  explicit TimingWheel(int64_t now = 0) : m_now(now) {}
+
+  int64_t now() const { return m_now; }
+  size_t size() const { return m_size; }
+  bool empty() const { return m_size == 0; }
+
+  // Fires once the wheel has advanced to `when`. Times at or before now()
+  // fire on the next advance.
+  void schedule(int64_t when, T item) {
+    // An empty wheel can be moved back for free, so event-time replay of
+    // older data starts from its own clock
+    if (m_size == 0 && when - 1 < m_now)
+      m_now = when - 1;
+    if (when <= m_now)
+      when = m_now + 1;
+    insert(Entry{when, move(item)});
+    ++m_size;
+  }
+
+  // Advances to `to`, calling onExpire(when, item) for each due entry in time
+  // order. onExpire may schedule new entries.
+  template <typename Fn> void advance(int64_t to, Fn onExpire) {
+    while (m_now < to) {
+      if (m_size == 0) {
+        m_now = to;
+        return;
+      }
+      // Skip ahead while the lower levels hold nothing
+      int level = 0;
+      while (level < kLevels && m_levelCount[level] == 0)
+        ++level;
+      if (level > 0) {
+        int shift = level == kLevels ? kOverflowShift : kShift[level];
+        int64_t next = m_now | ((int64_t(1) << shift) - 1);
+        if (next >= to) {
+          m_now = to;
+          return;
+        }
+        m_now = next;
+      }
+
+      ++m_now;
+      if ((m_now & 255) == 0)
+        cascadeFrom(1);
+
+      auto &slot = m_slots[0][m_now & 255];
+      if (!slot.empty()) {
+        m_due.clear();
+        swap(m_due, slot);
+        m_levelCount[0] -= m_due.size();
+        m_size -= m_due.size();
+        for (auto &entry : m_due)
+          onExpire(entry.when, entry.item);
+      }
+    }
+  }
+
+private:
+  struct Entry {
+    int64_t when;
+    T item;
+  };
+
+  static constexpr int kLevels = 4;
+  static constexpr int kShift[kLevels] = {0, 8, 14, 20};
+  static constexpr int kOverflowShift = 26;
+
+  static size_t slotCount(int level) { return level == 0 ? 256 : 64; }
+
+  size_t slotIndex(int level, int64_t when) const {
+    return static_cast<size_t>((when >> kShift[level]) &
+                               (slotCount(level) - 1));
+  }
+
+  void insert(Entry entry) {
+    int64_t delta = entry.when - m_now;
+    int level = 0;
+    if (delta >= (int64_t(1) << kOverflowShift)) {
+      m_overflow.push_back(move(entry));
+      return;
+    }
+    while (level + 1 < kLevels && delta >= (int64_t(1) << kShift[level + 1]))
+      ++level;
+    m_slots[level][slotIndex(level, entry.when)].push_back(move(entry));
+    ++m_levelCount[level];
+  }
+
+  // Called when level-1 wraps: pulls the now-current slot of `level` (and,
+  // if that wraps too, of the levels above) down into the lower levels.
+  void cascadeFrom(int level) {
+    if (level == kLevels) {
+      vector<Entry> overflow;
+      swap(overflow, m_overflow);
+      for (auto &entry : overflow)
+        insert(move(entry));
+      return;
+    }
+    size_t index = slotIndex(level, m_now);
+    if (index == 0)
+      cascadeFrom(level + 1);
+    vector<Entry> entries;
+    swap(entries, m_slots[level][index]);
+    m_levelCount[level] -= entries.size();
+    for (auto &entry : entries)
+      insert(move(entry));
+  }
+
+  int64_t m_now;
+  size_t m_size = 0;
+  array<vector<vector<Entry>>, kLevels> m_slots{
+      vector<vector<Entry>>(256), vector<vector<Entry>>(64),
+      vector<vector<Entry>>(64), vector<vector<Entry>>(64)};
+  array<size_t, kLevels> m_levelCount{};
+  vector<Entry> m_overflow;
+  vector<Entry> m_due;
+};
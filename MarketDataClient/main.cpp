@@ -7,39 +7,20 @@
 #undef ssize_t
 
 #include <ixwebsocket/IXNetSystem.h>
-#include <ixwebsocket/IXWebSocketServer.h>
-#include <nlohmann/json.hpp>
 
 #include "../Logger.h"
+#include "../Platform.h"
+#include "ClientConfig.h"
 #include "FIXMarketDataApp.h"
-#include <windows.h>
+#include "QuoteFeedServer.h"
 
-using json = nlohmann::json;
 using namespace std;
 using namespace Logger;
 using namespace FIX;
 namespace fs = filesystem;
 
-// Global for signal handling
-atomic<bool> g_running(true);
-OHLCBarAggregator *g_ohlc = nullptr;
-SocketInitiator *g_initiator = nullptr;
-
-BOOL WINAPI ConsoleHandler(DWORD dwType) {
-  if (dwType == CTRL_C_EVENT || dwType == CTRL_BREAK_EVENT) {
-    info("Shutdown signal received...");
-    g_running = false;
-    if (g_initiator)
-      g_initiator->stop();
-    if (g_ohlc)
-      g_ohlc->flushAll();
-    return TRUE;
-  }
-  return FALSE;
-}
-
 int main(int argc, char **argv) {
-  SetConsoleCtrlHandler(ConsoleHandler, TRUE);
+  Platform::installShutdownHandler();
   init("log", "client.log");
   // init("log", "client.log"); // Moved below argument parsing
 
@@ -59,21 +40,67 @@ int main(int argc, char **argv) {
 
     SessionSettings settings(configPath);
     int updateIntervalMs = 1000;
-
-    try {
-      const Dictionary &defaults = settings.get();
-      if (defaults.has("WebSocketPort"))
-        wsPort = stoi(defaults.getString("WebSocketPort"));
-      if (defaults.has("ClientID"))
-        clientId = defaults.getString("ClientID");
-      if (defaults.has("FrontendUpdateInterval"))
-        updateIntervalMs = stoi(defaults.getString("FrontendUpdateInterval"));
-    } catch (...) {
+    bool shmEnabled = false;
+    string shmName;
+    uint32_t shmMaxKeys = 1024;
+    bool journalEnabled = false;
+    string journalDir;
+    BarCloseMode barCloseMode = BarCloseMode::WallClock;
+    bool emitEmptyBars = false;
+
+    const Dictionary &defaults = settings.get();
+    if (defaults.has("WebSocketPort")) {
+      wsPort = configInt("WebSocketPort", defaults.getString("WebSocketPort"),
+                         1, 65535);
+    }
+    if (defaults.has("ClientID"))
+      clientId = defaults.getString("ClientID");
+    if (defaults.has("FrontendUpdateInterval")) {
+      updateIntervalMs =
+          configInt("FrontendUpdateInterval",
+                    defaults.getString("FrontendUpdateInterval"), 1, INT_MAX);
+    }
+    if (defaults.has("SharedMemory"))
+      shmEnabled = configBool(defaults, "SharedMemory");
+    if (defaults.has("SharedMemoryName"))
+      shmName = defaults.getString("SharedMemoryName");
+    if (defaults.has("SharedMemoryMaxKeys")) {
+      shmMaxKeys =
+          configInt("SharedMemoryMaxKeys",
+                    defaults.getString("SharedMemoryMaxKeys"), 1, UINT32_MAX);
+    }
+    if (defaults.has("TickJournal"))
+      journalEnabled = configBool(defaults, "TickJournal");
+    if (defaults.has("TickJournalDir"))
+      journalDir = defaults.getString("TickJournalDir");
+    if (defaults.has("BarCloseMode")) {
+      // Live ticks are stamped with the wall clock, so EventTime would only
+      // stop bars closing on quiet symbols; it is for replay through
+      // onPrice(Tick)/onPrices
+      string mode = defaults.getString("BarCloseMode");
+      if (mode == "EventTime")
+        throw ConfigError("BarCloseMode=EventTime is for replay only; the "
+                          "live client needs WallClock");
+      if (mode != "WallClock")
+        throw ConfigError("BarCloseMode=" + mode + " is not WallClock");
+    }
+    if (defaults.has("EmitEmptyBars"))
+      emitEmptyBars = configBool(defaults, "EmitEmptyBars");
+    // PriceDecimals=<n> sets the default increment, PriceDecimals_<SYMBOL>
+    // overrides it per symbol (keys are upper-cased by QuickFIX).
+    const string decimalsKey = "PRICEDECIMALS";
+    for (const auto &[key, value] : defaults) {
+      if (key == decimalsKey) {
+        PriceScales::setDefaultDecimals(configInt(key, value, 0, 9));
+      } else if (key.rfind(decimalsKey + "_", 0) == 0) {
+        PriceScales::setDecimals(key.substr(decimalsKey.size() + 1),
+                                 configInt(key, value, 0, 9));
+      }
     }
 
     // CLI overrides config file
     if (argc > 2)
-      wsPort = stoi(argv[2]);
+      wsPort = configInt("WebSocketPort", argv[2], 1, 65535);
     if (argc > 3)
       clientId = argv[3];
 
@@ -89,90 +116,61 @@ int main(int argc, char **argv) {
     if (!fs::exists(ohlcDir))
       fs::create_directory(ohlcDir);
 
-    map<string, WSMessage> priceCache;
-    mutex cacheMutex;
-
-    ix::WebSocketServer wsServer(wsPort, "0.0.0.0");
-    wsServer.setOnClientMessageCallback(
-        [&priceCache, &cacheMutex](
-            shared_ptr<ix::ConnectionState> connectionState,
-            ix::WebSocket &webSocket, const ix::WebSocketMessagePtr &msg) {
-          if (msg->type == ix::WebSocketMessageType::Open) {
-            lock_guard<mutex> lock(cacheMutex);
-            for (auto const &[symbol, latestMsg] : priceCache) {
-              json j;
-              j["symbol"] = latestMsg.symbol;
-              j["bid"] = latestMsg.bid;
-              j["ask"] = latestMsg.ask;
-              j["timestamp"] =
-                  chrono::duration_cast<chrono::seconds>(
-                      chrono::system_clock::now().time_since_epoch())
-                      .count();
-              webSocket.send(j.dump());
-            }
-          }
-        });
-
-    auto res = wsServer.listen();
-    if (!res.first) {
-      error("WebSocket server failed to start on port " + to_string(wsPort) +
-            ": " + res.second);
-    } else {
-      wsServer.start();
-      info("WebSocket server started on port " + to_string(wsPort));
+    QuoteFeedServer feed(wsPort);
+    feed.start();
+
+    // Declared before the app so they outlive its bar-clock thread
+    unique_ptr<SharedMarketDataPublisher> shm;
+    unique_ptr<TickJournal> journal;
+
+    FIXMarketDataApp app(settings, clientId);
+
+    if (shmEnabled) {
+      // One region per client; creating it fails if the name is taken
+      shm = make_unique<SharedMarketDataPublisher>(
+          shmName.empty() ? "MarketDataClient_" + clientId : shmName,
+          shmMaxKeys, app.timeframeSeconds());
+      app.setSharedMemory(shm.get());
     }
 
-    OHLCBarAggregator ohlc(clientId);
-    g_ohlc = &ohlc;
+    if (journalEnabled) {
+      journal = make_unique<TickJournal>(
+          journalDir.empty() ? "tick_journal_" + clientId : journalDir);
+      app.setJournal(journal.get());
+    }
+    app.setBarClose(barCloseMode, emitEmptyBars);
 
-    FIXMarketDataApp app(ohlc);
     FileStoreFactory storeFactory(settings);
     FileLogFactory logFactory(settings);
     SocketInitiator initiator(app, storeFactory, settings, logFactory);
-    g_initiator = &initiator;
 
     initiator.start();
     info("Client is running. Press CTRL+C to quit.");
 
     auto lastFrontendUpdate = chrono::system_clock::now();
-    while (g_running) {
+    while (!Platform::shutdownRequested()) {
       auto now = chrono::system_clock::now();
       auto elapsed =
           chrono::duration_cast<chrono::milliseconds>(now - lastFrontendUpdate)
               .count();
 
       WSMessage msg;
-      {
-        lock_guard<mutex> lock(cacheMutex);
-        while (app.popWSUpdate(msg)) {
-          priceCache[msg.symbol] = msg;
-        }
+      while (app.popWSUpdate(msg)) {
+        feed.apply(msg);
       }
 
       if (elapsed >= updateIntervalMs) {
-        lock_guard<mutex> lock(cacheMutex);
-        if (!priceCache.empty()) {
-          for (auto &[symbol, latestMsg] : priceCache) {
-            json j;
-            j["symbol"] = symbol;
-            j["bid"] = latestMsg.bid;
-            j["ask"] = latestMsg.ask;
-            j["timestamp"] =
-                chrono::duration_cast<chrono::seconds>(now.time_since_epoch())
-                    .count();
-            string payload = j.dump();
-            for (auto &&client : wsServer.getClients()) {
-              client->send(payload);
-            }
-          }
-        }
+        feed.publish(now);
         lastFrontendUpdate = now;
       }
       this_thread::sleep_for(chrono::milliseconds(50));
     }
 
+    info("Shutdown signal received...");
     initiator.stop();
-    wsServer.stop();
+    app.stopBarClock();
+    app.flushAll();
+    feed.stop();
     info("Client shut down cleanly.");
   } catch (ConfigError &e) {
     error("FIX Configuration Error: " + string(e.what()));
@@ -0,0 +1,350 @@
+#pragma once
+
+#include <bits/stdc++.h>
+#include <quickfix/Application.h>
+#include <quickfix/MessageCracker.h>
+#include <quickfix/Mutex.h>
+#include <quickfix/SessionSettings.h>
+#include <quickfix/Values.h>
+#include <quickfix/fix44/MarketDataIncrementalRefresh.h>
+#include <quickfix/fix44/MarketDataRequest.h>
+#include <quickfix/fix44/MarketDataSnapshotFullRefresh.h>
+
+#include "../Logger.h"
+#include "PriceEngine.h"
+#include "SessionOutbox.h"
+
+using namespace std;
+using namespace FIX;
+using namespace Logger;
+
+// FIX acceptor that moves a set of prices with PriceEngine and streams them
+// to every subscribed session.
+//
+// Settings ([DEFAULT]):
+//   Symbols=EURUSD:1.08500,...  symbols and start prices (default: EURUSD,
+//                               GBPUSD, USDJPY); the tick size defaults to
+//                               the last decimal of the start price
+//   TickSize_<SYMBOL>           overrides that tick size
+//   Volatility=0.08             annualised volatility; Volatility_<SYMBOL>
+//                               per symbol
+//   FactorLoadings=0.5          loadings on the common factors, comma
+//                               separated; FactorLoadings_<SYMBOL> per symbol
+//   PriceSeed=1                 RNG seed, so runs are reproducible (0 picks
+//                               a random one)
+//   UpdateIntervalMs=100        one update per symbol per interval
+//   LogUpdates=Y                log every update (turn off under load)
+//   OutboundHighWaterMark, OutboundStatsInterval: see SessionOutbox
+class MarketDataSimulator : public Application, public MessageCracker {
+public:
+  MarketDataSimulator(const SessionSettings &settings) : m_running(true) {
+    const Dictionary &defaults = settings.get();
+    if (defaults.has("OutboundHighWaterMark"))
+      m_highWaterMark = boundedInt(defaults, "OutboundHighWaterMark", 1);
+    if (defaults.has("OutboundStatsInterval"))
+      m_statsInterval =
+          chrono::seconds(boundedInt(defaults, "OutboundStatsInterval", 1));
+    if (defaults.has("UpdateIntervalMs"))
+      m_updateInterval =
+          chrono::milliseconds(boundedInt(defaults, "UpdateIntervalMs", 1));
+    if (defaults.has("LogUpdates"))
+      m_logUpdates = defaults.getBool("LogUpdates");
+
+    loadPriceModel(defaults);
+
+    m_updateThread = thread([this]() { priceUpdateLoop(); });
+  }
+
+  ~MarketDataSimulator() { stopUpdates(); }
+
+  // Stops generating prices; queued updates still go out.
+  void stopUpdates() {
+    m_running = false;
+    if (m_updateThread.joinable())
+      m_updateThread.join();
+    reapRetiredOutboxes();
+  }
+
+  // Outbox counters over all sessions, including those already logged out.
+  OutboxTotals outboundTotals() {
+    lock_guard<mutex> lock(m_mutex);
+    OutboxTotals totals = m_closedTotals;
+    for (auto &pair : m_outboxes)
+      totals += pair.second->totals();
+    for (auto &outbox : m_retired)
+      totals += outbox->totals();
+    return totals;
+  }
+
+  // Application overrides
+  void onCreate(const SessionID &sessionID) noexcept override {
+    info("Session created: " + sessionID.toString());
+  }
+  void onLogon(const SessionID &sessionID) noexcept override {
+    info("Logon: " + sessionID.toString());
+    lock_guard<mutex> lock(m_mutex);
+    auto &outbox = m_outboxes[sessionID];
+    // A logon without a logout in between: retire the old outbox like
+    // onLogout does rather than joining its sender in this callback
+    if (outbox) {
+      outbox->requestStop();
+      m_retired.push_back(move(outbox));
+    }
+    outbox = make_unique<SessionOutbox>(sessionID, m_highWaterMark,
+                                        m_statsInterval);
+  }
+  void onLogout(const SessionID &sessionID) noexcept override {
+    info("Logout: " + sessionID.toString());
+    lock_guard<mutex> lock(m_mutex);
+    for (auto &sessions : m_subscriptions) {
+      sessions.erase(sessionID);
+    }
+    // QuickFIX holds the session lock here, and the sender thread may be
+    // waiting on it inside sendToTarget, so only signal it; the update
+    // thread joins it later
+    auto it = m_outboxes.find(sessionID);
+    if (it != m_outboxes.end()) {
+      it->second->requestStop();
+      m_retired.push_back(move(it->second));
+      m_outboxes.erase(it);
+    }
+  }
+
+  void toAdmin(Message &message, const SessionID &sessionID) noexcept override {
+  }
+  void toApp(Message &message, const SessionID &sessionID) noexcept override {
+    crack(message, sessionID);
+  }
+  void fromAdmin(const Message &message,
+                 const SessionID &sessionID) noexcept override {}
+  void fromApp(const Message &message,
+               const SessionID &sessionID) noexcept override {
+    crack(message, sessionID);
+  }
+
+  // MessageCracker overrides
+  void onMessage(const FIX44::MarketDataRequest &message,
+                 const SessionID &sessionID) override {
+    info("Received Market Data Request");
+
+    MDReqID mdReqID;
+    SubscriptionRequestType subType;
+    NoRelatedSym noRelatedSym;
+
+    message.get(mdReqID);
+    message.get(subType);
+    message.get(noRelatedSym);
+
+    FIX44::MarketDataRequest::NoRelatedSym group;
+    for (int i = 1; i <= noRelatedSym; ++i) {
+      message.getGroup(i, group);
+      Symbol symbol;
+      group.get(symbol);
+
+      optional<size_t> index;
+      FIX44::MarketDataSnapshotFullRefresh snapshot;
+      double price = 0;
+      {
+        lock_guard<mutex> lock(m_mutex);
+        index = m_engine.indexOf(symbol.getString());
+        if (!index)
+          continue;
+        snapshot = makeSnapshot(*index, mdReqID.getString());
+        price = m_engine.price(*index);
+      }
+      // Sent without m_mutex so a blocked socket cannot stall the update
+      // thread; the subscription starts only after the snapshot has gone
+      // out, so no incremental for the symbol can overtake it
+      Session::sendToTarget(snapshot, sessionID);
+      info("Sent snapshot for " + symbol.getString() + " @ " +
+           to_string(price));
+      if (subType == SubscriptionRequestType_SNAPSHOT_PLUS_UPDATES) {
+        lock_guard<mutex> lock(m_mutex);
+        // Unless the session logged out meanwhile
+        if (m_outboxes.count(sessionID)) {
+          m_subscriptions[*index].insert(sessionID);
+          info("Subscribed: " + symbol.getString());
+        }
+      }
+    }
+  }
+
+private:
+  // Builds the price engine from the Symbols, TickSize, Volatility,
+  // FactorLoadings and PriceSeed settings.
+  void loadPriceModel(const Dictionary &defaults) {
+    string symbols = defaults.has("Symbols")
+                         ? defaults.getString("Symbols")
+                         : "EURUSD:1.08500,GBPUSD:1.27000,USDJPY:150.000";
+    // Per-symbol keys come back upper-cased from QuickFIX
+    auto perSymbol = [&defaults](const string &key, const string &symbol) {
+      string upper = key + "_" + symbol;
+      transform(upper.begin(), upper.end(), upper.begin(), ::toupper);
+      for (const auto &[name, value] : defaults) {
+        if (name == upper)
+          return optional<string>(value);
+      }
+      return defaults.has(key) ? optional<string>(defaults.getString(key))
+                               : nullopt;
+    };
+    auto parseLoadings = [](const string &text) {
+      vector<double> loadings;
+      stringstream ss(text);
+      string item;
+      while (getline(ss, item, ','))
+        loadings.push_back(stod(item));
+      return loadings;
+    };
+
+    try {
+      stringstream ss(symbols);
+      string item;
+      while (getline(ss, item, ',')) {
+        size_t colon = item.find(':');
+        if (colon == string::npos)
+          throw ConfigError("Symbols entry '" + item + "' needs SYMBOL:price");
+        SymbolModel model;
+        model.symbol = item.substr(0, colon);
+        string price = item.substr(colon + 1);
+        model.price = stod(price);
+        size_t dot = price.find('.');
+        int decimals =
+            dot == string::npos ? 0 : static_cast<int>(price.size() - dot - 1);
+        model.tickSize = pow(10.0, -decimals);
+        if (auto tick = perSymbol("TickSize", model.symbol))
+          model.tickSize = stod(*tick);
+        if (auto vol = perSymbol("Volatility", model.symbol))
+          model.volatility = stod(*vol);
+        model.loadings =
+            parseLoadings(perSymbol("FactorLoadings", model.symbol)
+                              .value_or("0.5"));
+        m_engine.add(model);
+      }
+    } catch (invalid_argument &e) {
+      throw ConfigError(e.what());
+    }
+
+    uint64_t seed = 1;
+    if (defaults.has("PriceSeed"))
+      seed = stoull(defaults.getString("PriceSeed"));
+    if (seed == 0)
+      seed = (static_cast<uint64_t>(random_device()()) << 32) |
+             random_device()();
+    m_engine.reset(seed, m_updateInterval.count() / 1000.0);
+    m_subscriptions.resize(m_engine.size());
+    info("Price engine: " + to_string(m_engine.size()) + " symbols, seed " +
+         to_string(seed));
+  }
+
+  // A positive integer setting, at least `lo`; a negative value would wrap
+  // the unsigned high-water mark and a zero interval would busy-loop.
+  static int boundedInt(const Dictionary &defaults, const string &key,
+                        int lo) {
+    int value = defaults.getInt(key);
+    if (value < lo) {
+      throw ConfigError(key + "=" + to_string(value) + " must be at least " +
+                        to_string(lo));
+    }
+    return value;
+  }
+
+  FIX44::MarketDataSnapshotFullRefresh makeSnapshot(size_t index,
+                                                    const string &mdReqID) {
+    FIX44::MarketDataSnapshotFullRefresh snapshot;
+    snapshot.set(MDReqID(mdReqID));
+    snapshot.set(Symbol(m_engine.symbol(index)));
+
+    double price = m_engine.price(index);
+    double halfSpread = 20 * m_engine.tickSize(index);
+
+    // Bid
+    FIX44::MarketDataSnapshotFullRefresh::NoMDEntries bidGroup;
+    bidGroup.set(MDEntryType(MDEntryType_BID));
+    bidGroup.set(MDEntryPx(price - halfSpread));
+    snapshot.addGroup(bidGroup);
+
+    // Offer
+    FIX44::MarketDataSnapshotFullRefresh::NoMDEntries offerGroup;
+    offerGroup.set(MDEntryType(MDEntryType_OFFER));
+    offerGroup.set(MDEntryPx(price + halfSpread));
+    snapshot.addGroup(offerGroup);
+
+    // Trade
+    FIX44::MarketDataSnapshotFullRefresh::NoMDEntries tradeGroup;
+    tradeGroup.set(MDEntryType(MDEntryType_TRADE));
+    tradeGroup.set(MDEntryPx(price));
+    snapshot.addGroup(tradeGroup);
+    return snapshot;
+  }
+
+  // Joins the sender threads of logged-out sessions and folds their
+  // counters into m_closedTotals. Never called from a QuickFIX callback.
+  void reapRetiredOutboxes() {
+    vector<SessionOutbox *> retired;
+    {
+      lock_guard<mutex> lock(m_mutex);
+      for (auto &outbox : m_retired)
+        retired.push_back(outbox.get());
+    }
+    for (SessionOutbox *outbox : retired) {
+      outbox->stop();
+      lock_guard<mutex> lock(m_mutex);
+      m_closedTotals += outbox->totals();
+      m_retired.erase(find_if(m_retired.begin(), m_retired.end(),
+                              [outbox](const unique_ptr<SessionOutbox> &p) {
+                                return p.get() == outbox;
+                              }));
+    }
+  }
+
+  void priceUpdateLoop() {
+    // Fixed schedule rather than sleep-per-pass, so the rate does not sag by
+    // the time each pass takes
+    auto next = chrono::steady_clock::now();
+    while (m_running) {
+      next += m_updateInterval;
+      this_thread::sleep_until(next);
+      reapRetiredOutboxes();
+
+      lock_guard<mutex> lock(m_mutex);
+      // Every symbol moves each cycle, subscribed or not, so a seed always
+      // gives the same paths
+      m_engine.step();
+      auto generated = chrono::system_clock::now();
+      for (size_t i = 0; i < m_engine.size(); ++i) {
+        if (m_subscriptions[i].empty())
+          continue;
+        const string &symbol = m_engine.symbol(i);
+        double price = m_engine.price(i);
+        broadcastUpdate(symbol, price, m_engine.volume(i), generated,
+                        m_subscriptions[i]);
+        if (m_logUpdates)
+          info("Update: " + symbol + " = " + to_string(price));
+      }
+    }
+  }
+
+  // Hands the update to each subscriber's outbox; never blocks on a socket.
+  void broadcastUpdate(const string &symbol, double price, long volume,
+                       chrono::system_clock::time_point generated,
+                       const set<SessionID> &sessions) {
+    for (const auto &sessionID : sessions) {
+      auto it = m_outboxes.find(sessionID);
+      if (it != m_outboxes.end())
+        it->second->push(symbol, price, volume, generated);
+    }
+  }
+
+  PriceEngine m_engine;
+  vector<set<SessionID>> m_subscriptions; // by engine index
+  map<SessionID, unique_ptr<SessionOutbox>> m_outboxes;
+  vector<unique_ptr<SessionOutbox>> m_retired; // logged out, not yet joined
+  OutboxTotals m_closedTotals;
+  size_t m_highWaterMark = 64;
+  chrono::seconds m_statsInterval{10};
+  chrono::milliseconds m_updateInterval{100};
+  bool m_logUpdates = true;
+  mutex m_mutex;
+  atomic<bool> m_running;
+  thread m_updateThread;
+};
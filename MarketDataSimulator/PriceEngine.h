@@ -0,0 +1,206 @@
+#pragma once
+
+#include <bits/stdc++.h>
+
+using namespace std;
+
+// kLanes xoshiro256+ generators side by side, state stored per word across
+// lanes, so filling a batch is a loop over independent lanes the compiler
+// can vectorize. The output depends only on the seed and the sequence of
+// fills.
+class BatchRng {
+public:
+  static constexpr size_t kLanes = 8;
+
+  explicit BatchRng(uint64_t seed = 1) { reseed(seed); }
+
+  void reseed(uint64_t seed) {
+    uint64_t x = seed;
+    for (size_t lane = 0; lane < kLanes; ++lane) {
+      for (auto &word : m_state)
+        word[lane] = splitMix(x);
+    }
+  }
+
+  // Uniform doubles in [0, 1).
+  void fillUniform(double *out, size_t n) {
+    size_t i = 0;
+    for (; i + kLanes <= n; i += kLanes)
+      nextBlock(out + i);
+    if (i < n) {
+      double tail[kLanes];
+      nextBlock(tail);
+      copy(tail, tail + (n - i), out + i);
+    }
+  }
+
+  // Standard normals by Box-Muller over a uniform batch.
+  void fillNormal(double *out, size_t n) {
+    size_t half = (n + 1) / 2;
+    m_uniform.resize(2 * half);
+    m_normal.resize(2 * half);
+    fillUniform(m_uniform.data(), m_uniform.size());
+    const double *u1 = m_uniform.data(), *u2 = m_uniform.data() + half;
+    double *z1 = m_normal.data(), *z2 = m_normal.data() + half;
+    constexpr double kTwoPi = 6.283185307179586;
+    for (size_t i = 0; i < half; ++i) {
+      double r = sqrt(-2.0 * log(1.0 - u1[i])); // 1 - u is in (0, 1]
+      double theta = kTwoPi * u2[i];
+      z1[i] = r * cos(theta);
+      z2[i] = r * sin(theta);
+    }
+    copy(m_normal.begin(), m_normal.begin() + n, out);
+  }
+
+private:
+  static uint64_t splitMix(uint64_t &x) {
+    uint64_t z = (x += 0x9e3779b97f4a7c15ULL);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+  }
+
+  void nextBlock(double *out) {
+    auto &[s0, s1, s2, s3] = m_state;
+    for (size_t l = 0; l < kLanes; ++l) {
+      uint64_t result = s0[l] + s3[l];
+      uint64_t t = s1[l] << 17;
+      s2[l] ^= s0[l];
+      s3[l] ^= s1[l];
+      s1[l] ^= s2[l];
+      s0[l] ^= s3[l];
+      s2[l] ^= t;
+      s3[l] = (s3[l] << 45) | (s3[l] >> 19);
+      out[l] = static_cast<double>(result >> 11) * 0x1.0p-53;
+    }
+  }
+
+  array<array<uint64_t, kLanes>, 4> m_state;
+  vector<double> m_uniform, m_normal;
+};
+
+struct SymbolModel {
+  string symbol;
+  double price = 1.0;
+  double volatility = 0.08; // annualised, as a fraction
+  double tickSize = 0.00001;
+  vector<double> loadings;  // on the common factors
+};
+
+// Geometric Brownian motion for every symbol, driven by a few common factors
+// plus an idiosyncratic shock:
+//
+//   z_i = sum_k L_ik f_k + sqrt(1 - sum_k L_ik^2) e_i
+//
+// so two symbols are correlated by sum_k L_ik L_jk. Each step draws all
+// shocks in one batch and updates structure-of-arrays state, and quotes
+// are the path rounded to the symbol's tick size.
+class PriceEngine {
+public:
+  // Throws invalid_argument for a bad model.
+  size_t add(const SymbolModel &model) {
+    if (m_index.count(model.symbol))
+      throw invalid_argument("Duplicate symbol " + model.symbol);
+    if (model.price <= 0 || model.tickSize <= 0 || model.volatility < 0)
+      throw invalid_argument("Invalid price model for " + model.symbol);
+    double loaded = 0;
+    for (double l : model.loadings)
+      loaded += l * l;
+    if (loaded > 1.0)
+      throw invalid_argument("Factor loadings of " + model.symbol +
+                             " exceed 1 in total");
+    m_index[model.symbol] = m_models.size();
+    m_models.push_back(model);
+    return m_models.size() - 1;
+  }
+
+  // Lays out the state and restarts the paths from the configured prices.
+  void reset(uint64_t seed, double stepSeconds) {
+    constexpr double kSecondsPerYear = 365.0 * 86400.0;
+    size_t n = m_models.size();
+    m_factors = 0;
+    for (const auto &model : m_models)
+      m_factors = max(m_factors, model.loadings.size());
+
+    m_mid.resize(n);
+    m_quote.resize(n);
+    m_tick.resize(n);
+    m_invTick.resize(n);
+    m_scale.resize(n);
+    m_drift.resize(n);
+    m_idio.resize(n);
+    m_volume.resize(n);
+    m_shock.resize(n);
+    m_uniform.resize(n);
+    m_factorShock.resize(m_factors);
+    m_loadings.assign(m_factors * n, 0.0);
+
+    double dt = stepSeconds / kSecondsPerYear;
+    for (size_t i = 0; i < n; ++i) {
+      const SymbolModel &model = m_models[i];
+      double sigma = model.volatility;
+      m_mid[i] = model.price;
+      m_tick[i] = model.tickSize;
+      m_invTick[i] = 1.0 / model.tickSize;
+      m_quote[i] = nearbyint(model.price * m_invTick[i]) * m_tick[i];
+      m_scale[i] = sigma * sqrt(dt);
+      m_drift[i] = -0.5 * sigma * sigma * dt;
+      double loaded = 0;
+      for (size_t k = 0; k < model.loadings.size(); ++k) {
+        m_loadings[k * n + i] = model.loadings[k];
+        loaded += model.loadings[k] * model.loadings[k];
+      }
+      m_idio[i] = sqrt(1.0 - loaded);
+    }
+    m_rng.reseed(seed);
+  }
+
+  // Advances every symbol by one step.
+  void step() {
+    size_t n = m_models.size();
+    m_rng.fillNormal(m_factorShock.data(), m_factors);
+    m_rng.fillNormal(m_shock.data(), n);
+    m_rng.fillUniform(m_uniform.data(), n);
+
+    double *z = m_shock.data();
+    for (size_t i = 0; i < n; ++i)
+      z[i] *= m_idio[i];
+    for (size_t k = 0; k < m_factors; ++k) {
+      const double *l = m_loadings.data() + k * n;
+      double f = m_factorShock[k];
+      for (size_t i = 0; i < n; ++i)
+        z[i] += l[i] * f;
+    }
+    for (size_t i = 0; i < n; ++i) {
+      m_mid[i] *= exp(m_drift[i] + m_scale[i] * z[i]);
+      m_quote[i] = nearbyint(m_mid[i] * m_invTick[i]) * m_tick[i];
+      m_volume[i] = 10000 + static_cast<long>(m_uniform[i] * 90001.0);
+    }
+  }
+
+  size_t size() const { return m_models.size(); }
+  const string &symbol(size_t i) const { return m_models[i].symbol; }
+  double price(size_t i) const { return m_quote[i]; }
+  double tickSize(size_t i) const { return m_tick[i]; }
+  long volume(size_t i) const { return m_volume[i]; }
+
+  optional<size_t> indexOf(const string &symbol) const {
+    auto it = m_index.find(symbol);
+    if (it == m_index.end())
+      return nullopt;
+    return it->second;
+  }
+
+private:
+  vector<SymbolModel> m_models;
+  unordered_map<string, size_t> m_index;
+  size_t m_factors = 0;
+  BatchRng m_rng;
+
+  // Per-symbol state, one array per field
+  vector<double> m_mid, m_quote, m_tick, m_invTick;
+  vector<double> m_scale, m_drift, m_idio;
+  vector<long> m_volume;
+  vector<double> m_loadings; // factor-major: [k * n + i]
+  vector<double> m_shock, m_uniform, m_factorShock;
+};
@@ -0,0 +1,233 @@
+#pragma once
+
+#include <bits/stdc++.h>
+#include <quickfix/Session.h>
+#include <quickfix/fix44/MarketDataIncrementalRefresh.h>
+
+#include "../Logger.h"
+
+using namespace std;
+using namespace FIX;
+using namespace Logger;
+
+struct PriceUpdate {
+  string symbol;
+  double price = 0.0;
+  long volume = 0;
+  chrono::steady_clock::time_point enqueued; // first push; outbox lag stats
+  // When the price was generated; sent as MDEntryDate/MDEntryTime
+  chrono::system_clock::time_point generated;
+};
+
+// Lifetime counters of an outbox. Every pushed update is eventually either
+// sent, merged into a later one (conflated), dropped because the session
+// was gone or the outbox stopped (failed), or still pending.
+struct OutboxTotals {
+  uint64_t pushed = 0;
+  uint64_t sent = 0;
+  uint64_t conflated = 0;
+  uint64_t failed = 0;
+
+  OutboxTotals &operator+=(const OutboxTotals &other) {
+    pushed += other.pushed;
+    sent += other.sent;
+    conflated += other.conflated;
+    failed += other.failed;
+    return *this;
+  }
+};
+
+// Bounded outbound queue for one FIX session, drained by its own sender
+// thread so a slow reader only delays itself. Up to the high-water mark
+// every update is queued in order; beyond it the session is conflating and
+// only the latest update per symbol is kept (volumes are summed so traded
+// size is not lost). Conflated updates go out after the queued ones.
+class SessionOutbox {
+public:
+  SessionOutbox(const SessionID &sessionID, size_t highWaterMark,
+                chrono::seconds statsInterval)
+      : m_sessionID(sessionID), m_highWaterMark(highWaterMark),
+        m_statsInterval(statsInterval) {
+    m_sender = thread([this]() { senderLoop(); });
+  }
+
+  ~SessionOutbox() { stop(); }
+
+  // Tells the sender thread to finish after its current send, without
+  // waiting for it. Safe from QuickFIX callbacks, which hold the session
+  // lock the sender may be waiting on. Anything unsent counts as failed.
+  void requestStop() {
+    {
+      lock_guard<mutex> lock(m_mutex);
+      m_running = false;
+    }
+    m_cv.notify_one();
+  }
+
+  // requestStop() and wait for the sender thread. Must not be called while
+  // holding the session's lock.
+  void stop() {
+    requestStop();
+    if (m_sender.joinable())
+      m_sender.join();
+  }
+
+  void push(const string &symbol, double price, long volume,
+            chrono::system_clock::time_point generated) {
+    {
+      lock_guard<mutex> lock(m_mutex);
+      PriceUpdate update{symbol, price, volume, chrono::steady_clock::now(),
+                         generated};
+      ++m_totals.pushed;
+      if (m_conflated.empty() && m_queue.size() < m_highWaterMark) {
+        m_queue.push_back(move(update));
+      } else {
+        auto it = m_conflated.find(symbol);
+        if (it == m_conflated.end()) {
+          m_conflated.emplace(symbol, move(update));
+        } else {
+          // The entry carries the newest price, so it takes that price's
+          // generation time; the enqueue time stays the oldest so the lag
+          // stats show how long this symbol has been held back
+          it->second.price = price;
+          it->second.volume += volume;
+          it->second.generated = generated;
+          ++m_stats.conflated;
+          ++m_totals.conflated;
+        }
+      }
+      m_stats.maxDepth =
+          max(m_stats.maxDepth, m_queue.size() + m_conflated.size());
+    }
+    m_cv.notify_one();
+  }
+
+  OutboxTotals totals() {
+    lock_guard<mutex> lock(m_mutex);
+    return m_totals;
+  }
+
+private:
+  struct Stats {
+    uint64_t sent = 0;
+    uint64_t conflated = 0;
+    size_t maxDepth = 0;
+    chrono::steady_clock::duration maxLag{};
+    chrono::steady_clock::duration totalLag{};
+  };
+
+  void senderLoop() {
+    vector<PriceUpdate> batch;
+    auto lastStats = chrono::steady_clock::now();
+    while (true) {
+      {
+        unique_lock<mutex> lock(m_mutex);
+        m_cv.wait_for(lock, chrono::seconds(1), [this]() {
+          return !m_running || !m_queue.empty() || !m_conflated.empty();
+        });
+        if (!m_running) {
+          m_totals.failed += m_queue.size() + m_conflated.size();
+          m_queue.clear();
+          m_conflated.clear();
+          break;
+        }
+        batch.assign(make_move_iterator(m_queue.begin()),
+                     make_move_iterator(m_queue.end()));
+        m_queue.clear();
+        for (auto &entry : m_conflated)
+          batch.push_back(move(entry.second));
+        m_conflated.clear();
+      }
+
+      // Send outside the lock: a blocked socket stalls only this thread
+      // while push() keeps accepting (and conflating) updates
+      for (size_t i = 0; i < batch.size(); ++i) {
+        {
+          lock_guard<mutex> lock(m_mutex);
+          if (!m_running) {
+            m_totals.failed += batch.size() - i;
+            break;
+          }
+        }
+        const PriceUpdate &update = batch[i];
+        bool sent = send(update);
+        auto lag = chrono::steady_clock::now() - update.enqueued;
+        lock_guard<mutex> lock(m_mutex);
+        if (!sent) {
+          ++m_totals.failed;
+          continue;
+        }
+        ++m_totals.sent;
+        ++m_stats.sent;
+        m_stats.totalLag += lag;
+        m_stats.maxLag = max(m_stats.maxLag, lag);
+      }
+      batch.clear();
+
+      auto now = chrono::steady_clock::now();
+      if (now - lastStats >= m_statsInterval) {
+        logStats();
+        lastStats = now;
+      }
+    }
+  }
+
+  bool send(const PriceUpdate &update) {
+    FIX44::MarketDataIncrementalRefresh refresh;
+    FIX44::MarketDataIncrementalRefresh::NoMDEntries group;
+    group.set(MDUpdateAction(MDUpdateAction_NEW));
+    group.set(MDEntryType(MDEntryType_TRADE));
+    group.set(Symbol(update.symbol));
+    group.set(MDEntryPx(update.price));
+    group.set(MDEntrySize(update.volume));
+    auto us = chrono::duration_cast<chrono::microseconds>(
+                  update.generated.time_since_epoch())
+                  .count();
+    time_t seconds = static_cast<time_t>(us / 1000000);
+    group.set(MDEntryDate(UtcDateOnly(seconds)));
+    group.set(MDEntryTime(
+        UtcTimeOnly(seconds, static_cast<int>(us % 1000000), 6), 6));
+    refresh.addGroup(group);
+    try {
+      return Session::sendToTarget(refresh, m_sessionID);
+    } catch (SessionNotFound &) {
+      return false;
+    }
+  }
+
+  void logStats() {
+    Stats stats;
+    {
+      lock_guard<mutex> lock(m_mutex);
+      stats = m_stats;
+      m_stats = Stats();
+    }
+    auto toMs = [](chrono::steady_clock::duration d) {
+      return chrono::duration_cast<chrono::microseconds>(d).count() / 1000.0;
+    };
+    stringstream ss;
+    ss << "Outbox " << m_sessionID.getTargetCompID().getString()
+       << ": sent=" << stats.sent << " conflated=" << stats.conflated
+       << " maxDepth=" << stats.maxDepth << " avgLagMs=" << fixed
+       << setprecision(3)
+       << (stats.sent ? toMs(stats.totalLag) / stats.sent : 0.0)
+       << " maxLagMs=" << toMs(stats.maxLag);
+    if (stats.conflated > 0)
+      warn(ss.str());
+    else
+      info(ss.str());
+  }
+
+  SessionID m_sessionID;
+  size_t m_highWaterMark;
+  chrono::seconds m_statsInterval;
+
+  deque<PriceUpdate> m_queue;
+  map<string, PriceUpdate> m_conflated;
+  Stats m_stats;
+  OutboxTotals m_totals;
+  bool m_running = true;
+  mutex m_mutex;
+  condition_variable m_cv;
+  thread m_sender;
+};
@@ -0,0 +1,200 @@
+#pragma once
+
+#include <bits/stdc++.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+using namespace std;
+
+// Reader for the Timestamp,Open,High,Low,Close,Volume,TickCount files written
+// by OHLCBarAggregator, working directly on a mapped byte range.
+//
+// Numbers are parsed eight characters at a time (SWAR): one 64-bit load finds
+// the length of the digit run and three multiplies turn up to eight digits
+// into their value, so a 10-digit timestamp or a "1.08512" price costs two
+// loads instead of a loop per character. Assumes a little-endian host.
+
+struct CsvBarRow {
+  int64_t timestamp = 0;
+  int64_t open = 0, high = 0, low = 0, close = 0; // at the reader's decimals
+  int64_t volume = 0;
+  int64_t tickCount = 0;
+};
+
+namespace Swar {
+constexpr array<uint64_t, 20> kPow10 = []() {
+  array<uint64_t, 20> powers{};
+  uint64_t value = 1;
+  for (auto &power : powers) {
+    power = value;
+    value *= 10;
+  }
+  return powers;
+}();
+
+inline int lowestSetBit(uint64_t v) {
+#ifdef _MSC_VER
+  unsigned long index;
+  _BitScanForward64(&index, v);
+  return static_cast<int>(index);
+#else
+  return __builtin_ctzll(v);
+#endif
+}
+
+// Eight bytes starting at p; past `end` the bytes read as zero, which is not
+// a digit, so a run never extends beyond the mapping.
+inline uint64_t load8(const char *p, const char *end) {
+  uint64_t chunk = 0;
+  memcpy(&chunk, p, end - p >= 8 ? 8 : static_cast<size_t>(end - p));
+  return chunk;
+}
+
+// Length of the run of ASCII digits at the start of chunk (0-8).
+inline int digitCount(uint64_t chunk) {
+  // Digits become 0-9; anything else gets bit 7 set, either directly or by
+  // the +0x76 overflow of values >= 10. Carries only reach later bytes.
+  uint64_t x = chunk ^ 0x3030303030303030ULL;
+  uint64_t mask = (x | (x + 0x7676767676767676ULL)) & 0x8080808080808080ULL;
+  return mask ? lowestSetBit(mask) >> 3 : 8;
+}
+
+// Value of the first n (1-8) digits of chunk.
+inline uint64_t parseDigits(uint64_t chunk, int n) {
+  // Left-align the digits; the zero bytes shifted in act as leading zeros
+  uint64_t v = chunk << (8 * (8 - n));
+  v = ((v & 0x0F0F0F0F0F0F0F0FULL) * 2561) >> 8;
+  v = ((v & 0x00FF00FF00FF00FFULL) * 6553601) >> 16;
+  return ((v & 0x0000FFFF0000FFFFULL) * 42949672960001ULL) >> 32;
+}
+
+// Parses the digit run at p into value; returns the number of digits.
+inline int parseUnsigned(const char *&p, const char *end, uint64_t &value) {
+  value = 0;
+  int count = 0;
+  for (;;) {
+    uint64_t chunk = load8(p, end);
+    int n = digitCount(chunk);
+    if (n > 0) {
+      value = value * kPow10[n] + parseDigits(chunk, n);
+      p += n;
+      count += n;
+    }
+    if (n < 8)
+      return count;
+  }
+}
+} // namespace Swar
+
+class BarCsvReader {
+public:
+  // Prices are returned as integers with `decimals` fraction digits; use
+  // priceDecimals() to find what the file itself was written with.
+  BarCsvReader(const char *begin, const char *end, int decimals)
+      : m_pos(begin), m_end(end), m_decimals(decimals) {
+    skipHeader();
+  }
+
+  // Fraction digits of the first row's open price (0 for an empty file).
+  static int priceDecimals(const char *begin, const char *end) {
+    BarCsvReader reader(begin, end, 0);
+    const char *p = reader.m_pos;
+    uint64_t ignored;
+    Swar::parseUnsigned(p, end, ignored);
+    if (p == end || *p++ != ',')
+      return 0;
+    int64_t mantissa;
+    int digits = 0;
+    parsePrice(p, end, mantissa, digits);
+    return digits;
+  }
+
+  // Next well-formed row; malformed lines are skipped and counted.
+  bool next(CsvBarRow &row) {
+    while (m_pos < m_end) {
+      const char *lineEnd =
+          static_cast<const char *>(memchr(m_pos, '\n', m_end - m_pos));
+      if (!lineEnd)
+        lineEnd = m_end;
+      bool ok = parseRow(m_pos, lineEnd, row);
+      m_pos = lineEnd < m_end ? lineEnd + 1 : m_end;
+      if (ok)
+        return true;
+      ++m_malformed;
+    }
+    return false;
+  }
+
+  size_t malformed() const { return m_malformed; }
+
+private:
+  void skipHeader() {
+    if (m_pos < m_end && (*m_pos < '0' || *m_pos > '9')) {
+      const char *lineEnd =
+          static_cast<const char *>(memchr(m_pos, '\n', m_end - m_pos));
+      m_pos = lineEnd ? lineEnd + 1 : m_end;
+    }
+  }
+
+  static bool parsePrice(const char *&p, const char *end, int64_t &mantissa,
+                         int &digits) {
+    bool negative = p < end && *p == '-';
+    if (negative)
+      ++p;
+    uint64_t whole, fraction = 0;
+    if (Swar::parseUnsigned(p, end, whole) == 0)
+      return false;
+    digits = 0;
+    if (p < end && *p == '.') {
+      ++p;
+      digits = Swar::parseUnsigned(p, end, fraction);
+    }
+    if (digits > 18)
+      return false;
+    int64_t value = static_cast<int64_t>(whole * Swar::kPow10[digits] +
+                                         fraction);
+    mantissa = negative ? -value : value;
+    return true;
+  }
+
+  bool field(const char *&p, const char *end, int64_t &out, bool price) {
+    if (price) {
+      int64_t mantissa;
+      int digits;
+      if (!parsePrice(p, end, mantissa, digits))
+        return false;
+      out = digits <= m_decimals
+                ? mantissa * static_cast<int64_t>(
+                                 Swar::kPow10[m_decimals - digits])
+                : mantissa / static_cast<int64_t>(
+                                 Swar::kPow10[digits - m_decimals]);
+      return true;
+    }
+    uint64_t value;
+    if (Swar::parseUnsigned(p, end, value) == 0)
+      return false;
+    out = static_cast<int64_t>(value);
+    return true;
+  }
+
+  bool parseRow(const char *p, const char *end, CsvBarRow &row) {
+    if (end > p && end[-1] == '\r')
+      --end;
+    int64_t *fields[7] = {&row.timestamp, &row.open,   &row.high,
+                          &row.low,       &row.close,  &row.volume,
+                          &row.tickCount};
+    for (int i = 0; i < 7; ++i) {
+      if (i > 0 && (p == end || *p++ != ','))
+        return false;
+      if (!field(p, end, *fields[i], i >= 1 && i <= 4))
+        return false;
+    }
+    return p == end;
+  }
+
+  const char *m_pos;
+  const char *m_end;
+  int m_decimals;
+  size_t m_malformed = 0;
+};
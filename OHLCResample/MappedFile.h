@@ -0,0 +1,91 @@
+#pragma once
+
+#include <bits/stdc++.h>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+using namespace std;
+
+// Read-only memory mapping of a whole file. An empty file maps to an empty
+// range.
+class MappedFile {
+public:
+  explicit MappedFile(const string &path) {
+#ifdef _WIN32
+    m_file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL,
+                         OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+    if (m_file == INVALID_HANDLE_VALUE)
+      throw runtime_error("Cannot open " + path);
+    LARGE_INTEGER size;
+    GetFileSizeEx(m_file, &size);
+    m_size = static_cast<size_t>(size.QuadPart);
+    if (m_size > 0) {
+      m_mapping = CreateFileMappingA(m_file, NULL, PAGE_READONLY, 0, 0, NULL);
+      if (m_mapping)
+        m_data = static_cast<const char *>(
+            MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0));
+    }
+#else
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+      throw runtime_error("Cannot open " + path);
+    struct stat st;
+    if (fstat(fd, &st) == 0)
+      m_size = static_cast<size_t>(st.st_size);
+    if (m_size > 0) {
+      void *base = mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+      if (base != MAP_FAILED) {
+        m_data = static_cast<const char *>(base);
+        // The parser makes one forward pass over the file
+        madvise(base, m_size, MADV_SEQUENTIAL);
+      }
+    }
+    ::close(fd);
+#endif
+    if (m_size > 0 && !m_data) {
+      release();
+      throw runtime_error("Cannot map " + path);
+    }
+  }
+
+  MappedFile(const MappedFile &) = delete;
+  MappedFile &operator=(const MappedFile &) = delete;
+  ~MappedFile() { release(); }
+
+  const char *begin() const { return m_data; }
+  const char *end() const { return m_data + m_size; }
+  size_t size() const { return m_size; }
+
+private:
+  void release() {
+#ifdef _WIN32
+    if (m_data)
+      UnmapViewOfFile(m_data);
+    if (m_mapping)
+      CloseHandle(m_mapping);
+    if (m_file != INVALID_HANDLE_VALUE)
+      CloseHandle(m_file);
+#else
+    if (m_data)
+      munmap(const_cast<char *>(m_data), m_size);
+#endif
+    m_data = nullptr;
+  }
+
+  const char *m_data = nullptr;
+  size_t m_size = 0;
+#ifdef _WIN32
+  HANDLE m_file = INVALID_HANDLE_VALUE;
+  HANDLE m_mapping = NULL;
+#endif
+};
@@ -0,0 +1,127 @@
+#pragma once
+
+#include <bits/stdc++.h>
+
+using namespace std;
+
+// Fixed-size thread pool with one task deque per worker. A worker takes the
+// newest task from its own deque and, when that is empty, steals the oldest
+// task from another worker's, so a few long tasks do not leave the other
+// threads idle. Tasks submitted from a worker go onto that worker's deque.
+// Each deque has its own lock; the pool-wide mutex is only taken to put an
+// idle worker to sleep or wake one, never to hand out a task.
+class WorkStealingPool {
+public:
+  explicit WorkStealingPool(size_t threads = thread::hardware_concurrency())
+      : m_queues(max<size_t>(threads, 1)) {
+    for (size_t i = 0; i < m_queues.size(); ++i)
+      m_workers.emplace_back([this, i]() { workerLoop(i); });
+  }
+
+  // Call wait() first; tasks still queued here are not run.
+  ~WorkStealingPool() {
+    {
+      lock_guard<mutex> lock(m_mutex);
+      m_running = false;
+    }
+    m_workAvailable.notify_all();
+    for (auto &worker : m_workers)
+      worker.join();
+  }
+
+  size_t size() const { return m_queues.size(); }
+
+  void submit(function<void()> task) {
+    size_t index =
+        t_pool == this ? t_workerIndex : m_nextQueue++ % m_queues.size();
+    m_pending.fetch_add(1);
+    {
+      lock_guard<mutex> lock(m_queues[index].tasksMutex);
+      m_queues[index].tasks.push_back(move(task));
+    }
+    // A worker about to sleep either sees the new signal or is counted in
+    // m_sleepers by the time we look
+    m_signal.fetch_add(1);
+    if (m_sleepers.load() > 0) {
+      lock_guard<mutex> lock(m_mutex);
+      m_workAvailable.notify_one();
+    }
+  }
+
+  // Blocks until every submitted task has finished.
+  void wait() {
+    unique_lock<mutex> lock(m_mutex);
+    m_idle.wait(lock, [this]() { return m_pending.load() == 0; });
+  }
+
+private:
+  struct Queue {
+    mutex tasksMutex;
+    deque<function<void()>> tasks;
+  };
+
+  bool popOwn(size_t index, function<void()> &task) {
+    Queue &queue = m_queues[index];
+    lock_guard<mutex> lock(queue.tasksMutex);
+    if (queue.tasks.empty())
+      return false;
+    task = move(queue.tasks.back());
+    queue.tasks.pop_back();
+    return true;
+  }
+
+  bool steal(size_t thief, function<void()> &task) {
+    for (size_t i = 1; i < m_queues.size(); ++i) {
+      Queue &queue = m_queues[(thief + i) % m_queues.size()];
+      lock_guard<mutex> lock(queue.tasksMutex);
+      if (!queue.tasks.empty()) {
+        task = move(queue.tasks.front());
+        queue.tasks.pop_front();
+        return true;
+      }
+    }
+    return false;
+  }
+
+  void workerLoop(size_t index) {
+    t_pool = this;
+    t_workerIndex = index;
+    function<void()> task;
+    while (true) {
+      // Read before searching, so a submit during the search wakes us
+      uint64_t seen = m_signal.load();
+      if (popOwn(index, task) || steal(index, task)) {
+        task();
+        task = nullptr;
+        if (m_pending.fetch_sub(1) == 1) {
+          lock_guard<mutex> lock(m_mutex);
+          m_idle.notify_all();
+        }
+        continue;
+      }
+      unique_lock<mutex> lock(m_mutex);
+      if (!m_running)
+        return;
+      ++m_sleepers;
+      m_workAvailable.wait(lock, [this, seen]() {
+        return !m_running || m_signal.load() != seen;
+      });
+      --m_sleepers;
+    }
+  }
+
+  vector<Queue> m_queues;
+  vector<thread> m_workers;
+  atomic<size_t> m_nextQueue{0};
+  atomic<size_t> m_pending{0};  // submitted and not finished
+  atomic<uint64_t> m_signal{0}; // bumped by every submit
+  atomic<size_t> m_sleepers{0}; // workers waiting on m_workAvailable
+
+  mutex m_mutex;
+  condition_variable m_workAvailable;
+  condition_variable m_idle;
+  bool m_running = true;
+
+  static inline thread_local WorkStealingPool *t_pool = nullptr;
+  static inline thread_local size_t t_workerIndex = 0;
+};
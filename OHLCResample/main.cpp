@@ -0,0 +1,328 @@
+#include <bits/stdc++.h>
+
+#include "../Logger.h"
+#include "../MarketDataClient/MessageWriter.h"
+#include "../MarketDataClient/Timeframe.h"
+#include "BarCsvParser.h"
+#include "MappedFile.h"
+#include "WorkStealingPool.h"
+
+using namespace std;
+using namespace Logger;
+namespace fs = filesystem;
+
+// Resamples the bar files of one or more OHLC_price_data_<id> directories
+// into other timeframes and merges them across client ids:
+//
+//   OHLCResample [--threads N] [--session-start HH:MM] <output_dir>
+//                <timeframes> <input_dir>...
+//
+// <timeframes> is a comma-separated list such as 2m,3h,1d (s/m/h/d, or plain
+// seconds). Buckets are aligned like the live aggregator's: to the epoch,
+// and for daily and longer bars to the session start (UTC). For every
+// symbol (and venue subdirectory) the coarsest source timeframe whose bars
+// nest inside the target's is used. Where several inputs
+// hold the same source bar, the one with the most ticks wins; the inputs are
+// usually recordings of the same feed, so summing them would double count.
+
+struct SourceFile {
+  fs::path path;
+  size_t root; // index of the input directory it came from
+  uintmax_t size;
+};
+
+// Source files of one output key, by source timeframe.
+using SourceSet = map<int64_t, vector<SourceFile>>;
+
+struct ResampleStats {
+  atomic<uint64_t> rowsIn{0};
+  atomic<uint64_t> barsOut{0};
+  atomic<uint64_t> duplicates{0};
+  atomic<uint64_t> outOfOrder{0};
+  atomic<uint64_t> malformed{0};
+  atomic<uint64_t> bytesIn{0};
+};
+
+// Finds <SYMBOL>_<tf>.csv files; a venue subdirectory becomes part of the key.
+void scanInput(const fs::path &root, size_t rootIndex,
+               map<string, SourceSet> &sources) {
+  for (const auto &entry : fs::recursive_directory_iterator(root)) {
+    if (!entry.is_regular_file() || entry.path().extension() != ".csv")
+      continue;
+    string stem = entry.path().stem().string();
+    size_t underscore = stem.rfind('_');
+    if (underscore == string::npos)
+      continue;
+    auto tf = Timeframes::parseSeconds(stem.substr(underscore + 1));
+    if (!tf)
+      continue;
+    fs::path venue = entry.path().parent_path().lexically_relative(root);
+    string key = stem.substr(0, underscore);
+    if (!venue.empty() && venue != ".")
+      key = venue.generic_string() + "/" + key;
+    sources[key][*tf].push_back(
+        {entry.path(), rootIndex, entry.file_size()});
+  }
+}
+
+// Source timeframe for a target: the one whose bars nest inside the
+// target's that the most inputs have, preferring the coarser on a tie.
+// Returns 0 if there is none.
+int64_t pickSource(const SourceSet &byTimeframe, const Timeframe &target) {
+  int64_t best = 0;
+  size_t bestRoots = 0;
+  for (const auto &[tf, files] : byTimeframe) {
+    if (target.seconds % tf != 0 || target.offset % tf != 0)
+      continue;
+    set<size_t> roots;
+    for (const auto &file : files)
+      roots.insert(file.root);
+    if (roots.size() >= bestRoots) {
+      best = tf;
+      bestRoots = roots.size();
+    }
+  }
+  return best;
+}
+
+// One input file being read in timestamp order.
+struct Cursor {
+  Cursor(const SourceFile &source, int decimals)
+      : file(source.path.string()),
+        reader(file.begin(), file.end(), decimals) {}
+
+  bool advance(ResampleStats &stats) {
+    int64_t last = valid ? row.timestamp : numeric_limits<int64_t>::min();
+    while ((valid = reader.next(row))) {
+      stats.rowsIn.fetch_add(1, memory_order_relaxed);
+      if (row.timestamp > last)
+        return true;
+      // A client restart can append a bucket it already wrote
+      stats.outOfOrder.fetch_add(1, memory_order_relaxed);
+    }
+    return false;
+  }
+
+  MappedFile file;
+  BarCsvReader reader;
+  CsvBarRow row;
+  bool valid = false;
+};
+
+// One resampled output file.
+struct BarOutput {
+  BarOutput(const Timeframe &target, const fs::path &path) : target(target) {
+    fs::create_directories(path.parent_path());
+    out.open(path, ios::binary | ios::trunc);
+    if (!out)
+      throw runtime_error("Cannot write " + path.string());
+    buffer.append(CsvWriter<OHLCBar>::header);
+  }
+
+  void add(const CsvBarRow &row, const PriceScale &scale,
+           ResampleStats &stats) {
+    int64_t rowBucket = target.bucketOf(row.timestamp);
+    if (open && rowBucket != bucket)
+      emit(scale, stats);
+    if (!open || rowBucket != bucket) {
+      bucket = rowBucket;
+      bar = OHLCBar();
+      bar.open = row.open;
+      bar.high = row.high;
+      bar.low = row.low;
+      open = true;
+    } else {
+      bar.high = max(bar.high, row.high);
+      bar.low = min(bar.low, row.low);
+    }
+    bar.close = row.close;
+    bar.volume += static_cast<long>(row.volume);
+    bar.tick_count += static_cast<int>(row.tickCount);
+  }
+
+  void finish(const PriceScale &scale, ResampleStats &stats) {
+    if (open)
+      emit(scale, stats);
+    out.write(buffer.data(), buffer.size());
+  }
+
+  void emit(const PriceScale &scale, ResampleStats &stats) {
+    bar.timestamp = chrono::system_clock::from_time_t(bucket);
+    CsvWriter<OHLCBar>::write(buffer, bar, scale);
+    stats.barsOut.fetch_add(1, memory_order_relaxed);
+    if (buffer.size() >= (1 << 20)) {
+      out.write(buffer.data(), buffer.size());
+      buffer.clear();
+    }
+  }
+
+  Timeframe target;
+  ofstream out;
+  MessageBuffer buffer;
+  OHLCBar bar;
+  int64_t bucket = 0;
+  bool open = false;
+};
+
+// Merges `files` (all of one source timeframe) and writes every target in a
+// single pass over the inputs.
+void resample(const vector<SourceFile> &files,
+              const vector<pair<Timeframe, fs::path>> &targets,
+              ResampleStats &stats) {
+  int decimals = 0;
+  for (const auto &source : files) {
+    MappedFile file(source.path.string());
+    decimals = max(decimals, BarCsvReader::priceDecimals(file.begin(),
+                                                         file.end()));
+  }
+  PriceScale scale = PriceScale::fromDecimals(decimals);
+
+  vector<unique_ptr<Cursor>> cursors;
+  for (const auto &source : files) {
+    cursors.push_back(make_unique<Cursor>(source, decimals));
+    cursors.back()->advance(stats);
+    stats.bytesIn.fetch_add(source.size, memory_order_relaxed);
+  }
+  vector<unique_ptr<BarOutput>> outputs;
+  for (const auto &[target, path] : targets)
+    outputs.push_back(make_unique<BarOutput>(target, path));
+
+  while (true) {
+    // Earliest source bar across the inputs; on a tie the fullest one
+    Cursor *best = nullptr;
+    for (auto &cursor : cursors) {
+      if (!cursor->valid)
+        continue;
+      if (!best || cursor->row.timestamp < best->row.timestamp ||
+          (cursor->row.timestamp == best->row.timestamp &&
+           cursor->row.tickCount > best->row.tickCount))
+        best = cursor.get();
+    }
+    if (!best)
+      break;
+    const CsvBarRow row = best->row;
+    for (auto &cursor : cursors) {
+      if (cursor->valid && cursor->row.timestamp == row.timestamp) {
+        if (cursor.get() != best)
+          stats.duplicates.fetch_add(1, memory_order_relaxed);
+        cursor->advance(stats);
+      }
+    }
+    for (auto &output : outputs)
+      output->add(row, scale, stats);
+  }
+
+  for (auto &output : outputs)
+    output->finish(scale, stats);
+  for (const auto &cursor : cursors)
+    stats.malformed.fetch_add(cursor->reader.malformed(),
+                              memory_order_relaxed);
+}
+
+int main(int argc, char **argv) {
+  try {
+    vector<string> args(argv + 1, argv + argc);
+    size_t threads = thread::hardware_concurrency();
+    int64_t sessionStart = 0;
+    while (args.size() >= 2 && args[0].rfind("--", 0) == 0) {
+      if (args[0] == "--threads")
+        threads = stoul(args[1]);
+      else if (args[0] == "--session-start")
+        sessionStart = Timeframes::parseSessionStart(args[1]);
+      else
+        throw runtime_error("Unknown option " + args[0]);
+      args.erase(args.begin(), args.begin() + 2);
+    }
+    if (args.size() < 3) {
+      cerr << "Usage: OHLCResample [--threads N] [--session-start HH:MM] "
+              "<output_dir> <timeframes> <input_dir>...\n"
+              "  e.g. OHLCResample merged 2m,3h,1d OHLC_price_data_1 "
+              "OHLC_price_data_2\n";
+      return 1;
+    }
+
+    fs::path outDir = args[0];
+    vector<Timeframe> targets = Timeframes::parseList(args[1], sessionStart);
+
+    map<string, SourceSet> sources;
+    for (size_t i = 2; i < args.size(); ++i) {
+      fs::path root = args[i];
+      if (!fs::is_directory(root))
+        throw runtime_error("Input directory '" + args[i] + "' not found");
+      if (fs::exists(outDir) && fs::equivalent(root, outDir))
+        throw runtime_error("Output directory must differ from the inputs");
+      scanInput(root, i - 2, sources);
+    }
+
+    // One task per symbol and source timeframe, covering every target that
+    // source feeds. Largest input first so the long ones start early and
+    // stealing evens out the tail.
+    struct Task {
+      const vector<SourceFile> *files;
+      vector<pair<Timeframe, fs::path>> targets;
+      uintmax_t bytes = 0;
+    };
+    vector<Task> tasks;
+    size_t outputCount = 0;
+    for (const auto &[key, byTimeframe] : sources) {
+      map<int64_t, Task> bySource;
+      for (const auto &target : targets) {
+        int64_t source = pickSource(byTimeframe, target);
+        if (source == 0) {
+          warn("No source timeframe fits " + target.name + " for " + key +
+               ", skipping");
+          continue;
+        }
+        Task &task = bySource[source];
+        task.files = &byTimeframe.at(source);
+        task.targets.emplace_back(target,
+                                  outDir / (key + "_" + target.name + ".csv"));
+        ++outputCount;
+      }
+      for (auto &[source, task] : bySource) {
+        for (const auto &file : *task.files)
+          task.bytes += file.size;
+        tasks.push_back(move(task));
+      }
+    }
+    sort(tasks.begin(), tasks.end(),
+         [](const Task &a, const Task &b) { return a.bytes > b.bytes; });
+
+    info("Resampling " + to_string(sources.size()) + " symbols into " +
+         to_string(outputCount) + " files on " + to_string(threads) +
+         " threads");
+    auto start = chrono::steady_clock::now();
+    ResampleStats stats;
+    atomic<size_t> failures{0};
+    {
+      WorkStealingPool pool(threads);
+      for (const auto &task : tasks) {
+        pool.submit([&task, &stats, &failures]() {
+          try {
+            resample(*task.files, task.targets, stats);
+          } catch (exception &e) {
+            error(task.files->front().path.string() + ": " + e.what());
+            ++failures;
+          }
+        });
+      }
+      pool.wait();
+    }
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() -
+                                              start)
+                         .count();
+
+    stringstream ss;
+    ss << "Done in " << fixed << setprecision(2) << seconds
+       << "s: rows=" << stats.rowsIn << " bars=" << stats.barsOut
+       << " duplicates=" << stats.duplicates
+       << " outOfOrder=" << stats.outOfOrder
+       << " malformed=" << stats.malformed << " MB/s="
+       << (seconds > 0 ? stats.bytesIn / 1e6 / seconds : 0.0);
+    info(ss.str());
+    return failures == 0 ? 0 : 1;
+  } catch (exception &e) {
+    error(string("Error: ") + e.what());
+    return 1;
+  }
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <bits/stdc++.h>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <csignal>
+#include <unistd.h>
+#endif
+
+using namespace std;
+namespace fs = filesystem;
+
+// The few OS-specific pieces the executables need: Ctrl+C / SIGINT /
+// SIGTERM handling and the executable's own path.
+namespace Platform {
+inline atomic<bool> shutdownFlag{false};
+
+#ifdef _WIN32
+inline BOOL WINAPI consoleHandler(DWORD type) {
+  if (type == CTRL_C_EVENT || type == CTRL_BREAK_EVENT ||
+      type == CTRL_CLOSE_EVENT) {
+    shutdownFlag = true;
+    return TRUE;
+  }
+  return FALSE;
+}
+#else
+inline void signalHandler(int) { shutdownFlag = true; }
+#endif
+
+// The handler only sets a flag; the main loop polls shutdownRequested() and
+// shuts down from its own thread.
+inline void installShutdownHandler() {
+#ifdef _WIN32
+  SetConsoleCtrlHandler(consoleHandler, TRUE);
+#else
+  signal(SIGINT, signalHandler);
+  signal(SIGTERM, signalHandler);
+#endif
+}
+
+inline bool shutdownRequested() { return shutdownFlag.load(); }
+
+inline fs::path executablePath(const char *argv0) {
+#ifdef _WIN32
+  wchar_t path[MAX_PATH];
+  if (GetModuleFileNameW(NULL, path, MAX_PATH))
+    return fs::path(path);
+#else
+  error_code ec;
+  fs::path self = fs::read_symlink("/proc/self/exe", ec);
+  if (!ec)
+    return self;
+#endif
+  return fs::absolute(argv0);
+}
+} // namespace Platform
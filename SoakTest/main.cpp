@@ -0,0 +1,527 @@
+#define ssize_t quickfix_ssize_t
+#include <bits/stdc++.h>
+#include <quickfix/MessageStore.h>
+#include <quickfix/SessionSettings.h>
+#include <quickfix/SocketInitiator.h>
+#include <quickfix/ThreadedSocketAcceptor.h>
+#undef ssize_t
+
+#include <ixwebsocket/IXNetSystem.h>
+#include <ixwebsocket/IXWebSocket.h>
+
+#include "../Logger.h"
+#include "../MarketDataClient/FIXMarketDataApp.h"
+#include "../MarketDataClient/QuoteFeedServer.h"
+#include "../MarketDataSimulator/MarketDataSimulator.h"
+#include "../Platform.h"
+
+using namespace std;
+using namespace Logger;
+using namespace FIX;
+namespace fs = filesystem;
+
+// In-process soak test: runs the simulator (acceptor) and the client
+// (initiator, aggregators, WebSocket feed) in one process over loopback FIX
+// and WebSocket, drives the load profile from soak.cfg for the configured
+// time and checks sustained throughput, unexplained drops and latency
+// percentiles. Results go to a key=value report meant to be diffed between
+// builds; the exit code is 0 only if every check passed.
+//
+//   MarketDataSoak [profile.cfg] [minutes]
+//
+// QuickFIX message logs and the client's per-trade log are off and stores
+// are in memory, so the run measures the pipeline rather than disk logging.
+
+// Latency histogram in microseconds: exact below 64us, then 32 buckets per
+// power of two (about 3% resolution). Safe to record from several threads.
+class LatencyHistogram {
+public:
+  LatencyHistogram() : m_counts(kBuckets) {}
+
+  void record(int64_t us) {
+    if (us < 0)
+      us = 0;
+    m_counts[indexOf(static_cast<uint64_t>(us))].fetch_add(
+        1, memory_order_relaxed);
+    m_total.fetch_add(1, memory_order_relaxed);
+  }
+
+  uint64_t count() const { return m_total.load(); }
+
+  // Upper bound of the bucket holding the p-th fraction of samples.
+  uint64_t percentile(double p) const {
+    uint64_t total = count();
+    if (total == 0)
+      return 0;
+    uint64_t rank = static_cast<uint64_t>(ceil(p * total));
+    uint64_t seen = 0;
+    for (size_t i = 0; i < kBuckets; ++i) {
+      seen += m_counts[i].load(memory_order_relaxed);
+      if (seen >= max<uint64_t>(rank, 1))
+        return upperBound(i);
+    }
+    return upperBound(kBuckets - 1);
+  }
+
+private:
+  static constexpr size_t kBuckets = 64 + 58 * 32;
+
+  static size_t indexOf(uint64_t us) {
+    if (us < 64)
+      return us;
+    int msb = 6;
+    while ((us >> (msb + 1)) != 0)
+      ++msb;
+    int shift = msb - 5;
+    return 64 + (msb - 6) * 32 + ((us >> shift) & 31);
+  }
+
+  static uint64_t upperBound(size_t index) {
+    if (index < 64)
+      return index;
+    size_t octave = (index - 64) / 32, sub = (index - 64) % 32;
+    int shift = static_cast<int>(octave) + 1;
+    return ((32 + sub + 1) << shift) - 1;
+  }
+
+  vector<atomic<uint64_t>> m_counts;
+  atomic<uint64_t> m_total{0};
+};
+
+// The real client application, plus a receive counter and two latency
+// samples for every incremental refresh: end to end from the simulator's
+// MDEntryDate/MDEntryTime generation stamp, which includes time spent queued
+// in its outbox (a conflated entry carries its newest price's stamp), and
+// wire only from SendingTime.
+class InstrumentedClientApp : public FIXMarketDataApp {
+public:
+  using FIXMarketDataApp::FIXMarketDataApp;
+
+  void fromApp(const Message &message,
+               const SessionID &sessionID) noexcept override {
+    FIXMarketDataApp::fromApp(message, sessionID);
+    MsgType type;
+    if (!message.getHeader().getFieldIfSet(type) ||
+        type.getValue() != MsgType_MarketDataIncrementalRefresh)
+      return;
+    auto done = chrono::duration_cast<chrono::microseconds>(
+                    chrono::system_clock::now().time_since_epoch())
+                    .count();
+    SendingTime sendingTime;
+    if (message.getHeader().getFieldIfSet(sendingTime)) {
+      const UtcTimeStamp &ts = sendingTime.getValue();
+      int64_t sentUs = static_cast<int64_t>(ts.getTimeT()) * 1000000LL +
+                       ts.getMicrosecond();
+      wireLatency.record(done - sentUs);
+    }
+    NoMDEntries entries;
+    if (message.getFieldIfSet(entries)) {
+      FIX44::MarketDataIncrementalRefresh::NoMDEntries group;
+      for (int i = 1; i <= entries; ++i) {
+        message.getGroup(i, group);
+        MDEntryDate date;
+        MDEntryTime time;
+        if (group.getFieldIfSet(date) && group.getFieldIfSet(time))
+          latency.record(done - generatedUs(date.getValue(), time.getValue()));
+      }
+    }
+    received.fetch_add(1, memory_order_relaxed);
+  }
+
+  atomic<uint64_t> received{0};
+  LatencyHistogram latency;
+  LatencyHistogram wireLatency;
+
+private:
+  static int64_t generatedUs(const UtcDateOnly &date,
+                             const UtcTimeOnly &time) {
+    int64_t seconds = static_cast<int64_t>(date.getTimeT()) +
+                      (time.getHour() * 60 + time.getMinute()) * 60 +
+                      time.getSecond();
+    return seconds * 1000000LL + time.getMicrosecond();
+  }
+};
+
+struct SoakProfile {
+  double minutes = 5;
+  int sessions = 2;
+  int symbols = 50;
+  int updateIntervalMs = 20;
+  int warmupSeconds = 5;
+  int fixPort = 9101;
+  int wsPort = 9102;
+  int frontendIntervalMs = 1000;
+  int outboundHighWaterMark = 64;
+  string dataDictionary = "FIX44.xml";
+  string runDir = "soak_run";
+  string reportFile = "soak_report.txt";
+
+  double minThroughputRatio = 0.95;
+  uint64_t maxUnexplainedDrops = 0;
+  double maxLatencyP50Ms = 5;
+  double maxLatencyP99Ms = 25;
+  double maxLatencyP999Ms = 100;
+  double maxFrameGapMs = 3000;
+
+  double expectedPerSecond() const {
+    return sessions * symbols * 1000.0 / updateIntervalMs;
+  }
+
+  static SoakProfile load(const string &path) {
+    SoakProfile p;
+    const Dictionary &d = SessionSettings(path).get();
+    auto num = [&d](const char *key, auto &out) {
+      if (d.has(key))
+        out = static_cast<remove_reference_t<decltype(out)>>(
+            stod(d.getString(key)));
+    };
+    num("SoakMinutes", p.minutes);
+    num("Sessions", p.sessions);
+    num("Symbols", p.symbols);
+    num("UpdateIntervalMs", p.updateIntervalMs);
+    num("WarmupSeconds", p.warmupSeconds);
+    num("FixPort", p.fixPort);
+    num("WebSocketPort", p.wsPort);
+    num("FrontendUpdateInterval", p.frontendIntervalMs);
+    num("OutboundHighWaterMark", p.outboundHighWaterMark);
+    num("MinThroughputRatio", p.minThroughputRatio);
+    num("MaxUnexplainedDrops", p.maxUnexplainedDrops);
+    num("MaxLatencyP50Ms", p.maxLatencyP50Ms);
+    num("MaxLatencyP99Ms", p.maxLatencyP99Ms);
+    num("MaxLatencyP999Ms", p.maxLatencyP999Ms);
+    num("MaxFrameGapMs", p.maxFrameGapMs);
+    if (d.has("DataDictionary"))
+      p.dataDictionary = d.getString("DataDictionary");
+    if (d.has("RunDir"))
+      p.runDir = d.getString("RunDir");
+    if (d.has("ReportFile"))
+      p.reportFile = d.getString("ReportFile");
+    return p;
+  }
+};
+
+// Settings shared by both ends of every session.
+Dictionary sessionDefaults(const SoakProfile &p, const string &connectionType,
+                           const string &senderCompID) {
+  Dictionary d;
+  d.setString("ConnectionType", connectionType);
+  d.setString("BeginString", "FIX.4.4");
+  d.setString("SenderCompID", senderCompID);
+  d.setString("UseDataDictionary", "Y");
+  d.setString("DataDictionary", p.dataDictionary);
+  d.setString("StartTime", "00:00:00");
+  d.setString("EndTime", "00:00:00");
+  d.setString("HeartBtInt", "30");
+  d.setString("ResetOnLogon", "Y");
+  d.setString("ResetOnLogout", "Y");
+  d.setString("ResetOnDisconnect", "Y");
+  d.setString("PersistMessages", "N");
+  // Microsecond SendingTime for the latency samples
+  d.setString("TimestampPrecision", "6");
+  return d;
+}
+
+string symbolName(int i) {
+  char name[16];
+  snprintf(name, sizeof(name), "SYM%03d", i);
+  return name;
+}
+
+struct Check {
+  string name;
+  string limit;
+  string actual;
+  bool passed;
+};
+
+int main(int argc, char **argv) {
+  Platform::installShutdownHandler();
+  ix::initNetSystem();
+
+  try {
+    string profilePath = argc > 1 ? argv[1] : "soak.cfg";
+    if (!fs::exists(profilePath))
+      throw runtime_error("Soak profile '" + profilePath + "' not found.");
+    SoakProfile p = SoakProfile::load(profilePath);
+    if (argc > 2)
+      p.minutes = stod(argv[2]);
+
+    // Everything the run writes (FIX stores, bar files, logs, the report)
+    // goes under RunDir
+    p.dataDictionary = fs::absolute(p.dataDictionary).string();
+    if (!fs::exists(p.dataDictionary))
+      throw runtime_error("Data dictionary '" + p.dataDictionary +
+                          "' not found.");
+    fs::create_directories(p.runDir);
+    fs::current_path(p.runDir);
+    init("log", "soak.log");
+
+    // Start prices at the client's increment for each symbol, so the
+    // simulator quotes what the client can represent exactly
+    string symbols, prices;
+    for (int i = 0; i < p.symbols; ++i) {
+      string name = symbolName(i);
+      PriceScale scale = PriceScales::forSymbol(name);
+      symbols += (i ? "," : "") + name;
+      prices += (i ? "," : "") + name + ":" +
+                scale.toString(scale.fromDouble(1.0 + 0.01 * i));
+    }
+
+    SessionSettings serverSettings;
+    Dictionary server = sessionDefaults(p, "acceptor", "SERVER1");
+    server.setString("SocketAcceptPort", to_string(p.fixPort));
+    server.setString("Symbols", prices);
+    server.setString("UpdateIntervalMs", to_string(p.updateIntervalMs));
+    server.setString("LogUpdates", "N");
+    server.setString("OutboundHighWaterMark",
+                     to_string(p.outboundHighWaterMark));
+    serverSettings.set(server);
+
+    SessionSettings clientSettings;
+    Dictionary client = sessionDefaults(p, "initiator", "CLIENT1");
+    client.setString("SocketConnectHost", "127.0.0.1");
+    client.setString("SocketConnectPort", to_string(p.fixPort));
+    client.setString("Symbols", symbols);
+    client.setString("LogTrades", "N");
+    clientSettings.set(client);
+
+    for (int i = 1; i <= p.sessions; ++i) {
+      string clientCompID = "CLIENT" + to_string(i);
+      serverSettings.set(SessionID("FIX.4.4", "SERVER1", clientCompID),
+                         Dictionary());
+      Dictionary session;
+      session.setString("VenueID", "SIM" + to_string(i));
+      clientSettings.set(SessionID("FIX.4.4", clientCompID, "SERVER1"),
+                         session);
+    }
+
+    info("Soak: " + to_string(p.sessions) + " sessions x " +
+         to_string(p.symbols) + " symbols every " +
+         to_string(p.updateIntervalMs) + "ms (" +
+         to_string(static_cast<long>(p.expectedPerSecond())) +
+         " updates/s) for " + to_string(p.minutes) + " min");
+
+    MarketDataSimulator simulator(serverSettings);
+    MemoryStoreFactory serverStore;
+    ThreadedSocketAcceptor acceptor(simulator, serverStore, serverSettings);
+
+    QuoteFeedServer feed(p.wsPort, "127.0.0.1");
+    if (!feed.start())
+      throw runtime_error("WebSocket port " + to_string(p.wsPort) +
+                          " unavailable");
+
+    InstrumentedClientApp app(clientSettings, "soak");
+    MemoryStoreFactory clientStore;
+    SocketInitiator initiator(app, clientStore, clientSettings);
+
+    // A browser stand-in on the WebSocket feed
+    mutex frameMutex;
+    uint64_t frames = 0;
+    chrono::steady_clock::time_point lastFrame;
+    chrono::steady_clock::duration maxFrameGap{};
+    bool measureGaps = false;
+    ix::WebSocket browser;
+    browser.setUrl("ws://127.0.0.1:" + to_string(p.wsPort));
+    browser.setOnMessageCallback([&](const ix::WebSocketMessagePtr &msg) {
+      if (msg->type != ix::WebSocketMessageType::Message)
+        return;
+      auto now = chrono::steady_clock::now();
+      lock_guard<mutex> lock(frameMutex);
+      ++frames;
+      if (measureGaps && lastFrame != chrono::steady_clock::time_point())
+        maxFrameGap = max(maxFrameGap, now - lastFrame);
+      lastFrame = now;
+    });
+
+    acceptor.start();
+    initiator.start();
+    browser.start();
+
+    // isLoggedOn() is true once any session is; the load must not start
+    // until all of them are
+    auto allLoggedOn = [&initiator]() {
+      for (const auto &sessionID : initiator.getSessions()) {
+        Session *session = initiator.getSession(sessionID);
+        if (!session || !session->isLoggedOn())
+          return false;
+      }
+      return true;
+    };
+    auto logonDeadline = chrono::steady_clock::now() + chrono::seconds(10);
+    while (!allLoggedOn() && chrono::steady_clock::now() < logonDeadline)
+      this_thread::sleep_for(chrono::milliseconds(50));
+    if (!allLoggedOn())
+      throw runtime_error("Not every FIX session logged on over loopback");
+
+    // Load phase: pump the client's WebSocket queue like its main loop and
+    // sample the receive rate once a second
+    auto start = chrono::steady_clock::now();
+    auto end = start + chrono::milliseconds(
+                           static_cast<int64_t>(p.minutes * 60000));
+    auto nextSample = start + chrono::seconds(1);
+    auto lastPublish = start;
+    uint64_t lastReceived = app.received.load();
+    vector<uint64_t> perSecond;
+    bool completed = true;
+    while (chrono::steady_clock::now() < end) {
+      if (Platform::shutdownRequested()) {
+        completed = false;
+        break;
+      }
+      WSMessage msg;
+      while (app.popWSUpdate(msg))
+        feed.apply(msg);
+      auto now = chrono::steady_clock::now();
+      if (now - lastPublish >= chrono::milliseconds(p.frontendIntervalMs)) {
+        feed.publish(chrono::system_clock::now());
+        lastPublish = now;
+      }
+      if (now >= nextSample) {
+        uint64_t received = app.received.load();
+        perSecond.push_back(received - lastReceived);
+        lastReceived = received;
+        nextSample += chrono::seconds(1);
+        if (perSecond.size() == static_cast<size_t>(p.warmupSeconds)) {
+          lock_guard<mutex> lock(frameMutex);
+          measureGaps = true;
+        }
+      }
+      this_thread::sleep_for(chrono::milliseconds(10));
+    }
+    {
+      lock_guard<mutex> lock(frameMutex);
+      measureGaps = false;
+    }
+
+    // Drain: stop generating and wait until everything sent has arrived
+    simulator.stopUpdates();
+    OutboxTotals totals = simulator.outboundTotals();
+    auto drainDeadline = chrono::steady_clock::now() + chrono::seconds(10);
+    while (chrono::steady_clock::now() < drainDeadline) {
+      totals = simulator.outboundTotals();
+      if (app.received.load() >=
+          totals.pushed - totals.conflated - totals.failed)
+        break;
+      this_thread::sleep_for(chrono::milliseconds(50));
+    }
+    uint64_t received = app.received.load();
+
+    browser.stop();
+    initiator.stop();
+    acceptor.stop();
+    feed.stop();
+    app.stopBarClock();
+    app.flushAll();
+
+    // Results
+    vector<uint64_t> sustained(
+        perSecond.begin() + min<size_t>(p.warmupSeconds, perSecond.size()),
+        perSecond.end());
+    uint64_t minRate =
+        sustained.empty() ? 0
+                          : *min_element(sustained.begin(), sustained.end());
+    double meanRate =
+        sustained.empty()
+            ? 0.0
+            : accumulate(sustained.begin(), sustained.end(), 0.0) /
+                  sustained.size();
+    // Conflation is the only expected loss. Failed sends are counted by the
+    // simulator but still mean a session lost data, and no session logs out
+    // during the run, so they get their own check; anything else that never
+    // arrived was lost somewhere in between
+    uint64_t explained = totals.conflated + totals.failed;
+    uint64_t unexplained = totals.pushed > explained + received
+                               ? totals.pushed - explained - received
+                               : 0;
+    auto ms = [](uint64_t us) { return us / 1000.0; };
+    double p50 = ms(app.latency.percentile(0.50));
+    double p90 = ms(app.latency.percentile(0.90));
+    double p99 = ms(app.latency.percentile(0.99));
+    double p999 = ms(app.latency.percentile(0.999));
+    double pMax = ms(app.latency.percentile(1.0));
+    double wireP50 = ms(app.wireLatency.percentile(0.50));
+    double wireP99 = ms(app.wireLatency.percentile(0.99));
+    double frameGapMs =
+        chrono::duration<double, milli>(maxFrameGap).count();
+
+    auto fmt = [](double v) {
+      stringstream ss;
+      ss << fixed << setprecision(3) << v;
+      return ss.str();
+    };
+    double minRatio = p.minThroughputRatio * p.expectedPerSecond();
+    vector<Check> checks = {
+        {"completed", "Y", completed ? "Y" : "N", completed},
+        {"throughput_min_per_sec", ">= " + fmt(minRatio), to_string(minRate),
+         !sustained.empty() && minRate >= minRatio},
+        {"unexplained_drops", "<= " + to_string(p.maxUnexplainedDrops),
+         to_string(unexplained), unexplained <= p.maxUnexplainedDrops},
+        {"send_failed", "0", to_string(totals.failed), totals.failed == 0},
+        {"latency_p50_ms", "<= " + fmt(p.maxLatencyP50Ms), fmt(p50),
+         p50 <= p.maxLatencyP50Ms},
+        {"latency_p99_ms", "<= " + fmt(p.maxLatencyP99Ms), fmt(p99),
+         p99 <= p.maxLatencyP99Ms},
+        {"latency_p999_ms", "<= " + fmt(p.maxLatencyP999Ms), fmt(p999),
+         p999 <= p.maxLatencyP999Ms},
+        {"websocket_frame_gap_ms", "<= " + fmt(p.maxFrameGapMs),
+         fmt(frameGapMs), frames > 0 && frameGapMs <= p.maxFrameGapMs},
+    };
+    bool passed = all_of(checks.begin(), checks.end(),
+                         [](const Check &c) { return c.passed; });
+
+    stringstream report;
+    report << "# MarketDataSoak report\n";
+#if defined(_MSC_VER)
+    report << "build.compiler=MSVC " << _MSC_VER << "\n";
+#elif defined(__VERSION__)
+    report << "build.compiler=" << __VERSION__ << "\n";
+#endif
+    report << "build.date=" << __DATE__ << " " << __TIME__ << "\n"
+           << "profile.minutes=" << fmt(p.minutes) << "\n"
+           << "profile.sessions=" << p.sessions << "\n"
+           << "profile.symbols=" << p.symbols << "\n"
+           << "profile.update_interval_ms=" << p.updateIntervalMs << "\n"
+           << "profile.outbound_high_water_mark=" << p.outboundHighWaterMark
+           << "\n"
+           << "profile.expected_per_sec=" << fmt(p.expectedPerSecond())
+           << "\n"
+           << "result.seconds_sampled=" << perSecond.size() << "\n"
+           << "result.throughput_min_per_sec=" << minRate << "\n"
+           << "result.throughput_mean_per_sec=" << fmt(meanRate) << "\n"
+           << "result.pushed=" << totals.pushed << "\n"
+           << "result.sent=" << totals.sent << "\n"
+           << "result.conflated=" << totals.conflated << "\n"
+           << "result.send_failed=" << totals.failed << "\n"
+           << "result.received=" << received << "\n"
+           << "result.unexplained_drops=" << unexplained << "\n"
+           << "result.latency_samples=" << app.latency.count() << "\n"
+           << "result.latency_p50_ms=" << fmt(p50) << "\n"
+           << "result.latency_p90_ms=" << fmt(p90) << "\n"
+           << "result.latency_p99_ms=" << fmt(p99) << "\n"
+           << "result.latency_p999_ms=" << fmt(p999) << "\n"
+           << "result.latency_max_ms=" << fmt(pMax) << "\n"
+           << "result.wire_latency_p50_ms=" << fmt(wireP50) << "\n"
+           << "result.wire_latency_p99_ms=" << fmt(wireP99) << "\n"
+           << "result.websocket_frames=" << frames << "\n"
+           << "result.websocket_max_gap_ms=" << fmt(frameGapMs) << "\n";
+    for (const auto &c : checks) {
+      report << "check." << c.name << "=" << (c.passed ? "PASS" : "FAIL")
+             << " (" << c.actual << ", limit " << c.limit << ")\n";
+    }
+    report << "verdict=" << (passed ? "PASS" : "FAIL") << "\n";
+
+    ofstream(p.reportFile) << report.str();
+    info("Soak report written to " +
+         (fs::current_path() / p.reportFile).string() + "\n" + report.str());
+    return passed ? 0 : 1;
+  } catch (ConfigError &e) {
+    error("FIX Configuration Error: " + string(e.what()));
+    return 2;
+  } catch (RuntimeError &e) {
+    error("FIX Runtime Error: " + string(e.what()));
+    return 2;
+  } catch (exception &e) {
+    error("Error: " + string(e.what()));
+    return 2;
+  }
+}
@@ -28,6 +28,7 @@
 #include <array>
 #include <atomic>
 #include <bitset>
+#include <charconv>
 #include <chrono>
 #include <codecvt>
 #include <complex>
@@ -54,6 +55,7 @@
 #include <mutex>
 #include <new>
 #include <numeric>
+#include <optional>
 #include <ostream>
 #include <queue>
 #include <random>
@@ -61,11 +63,13 @@
 #include <regex>
 #include <scoped_allocator>
 #include <set>
+#include <shared_mutex>
 #include <sstream>
 #include <stack>
 #include <stdexcept>
 #include <streambuf>
 #include <string>
+#include <string_view>
 #include <system_error>
 #include <thread>
 #include <tuple>
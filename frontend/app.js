@@ -125,38 +125,47 @@ socket.onclose = () => {
 
 socket.onmessage = (event) => {
     try {
-        const data = JSON.parse(event.data);
-        const row = document.getElementById(data.symbol);
-
-        if (row) {
-            const bidEl = row.querySelector('.bid');
-            const askEl = row.querySelector('.ask');
-            const lastUpdateEl = row.querySelector('.last-update');
-
-            // Update sparkline data
-            const history = priceHistory[data.symbol];
-            const midPrice = (data.bid + data.ask) / 2;
-            history.push(midPrice);
-            if (history.length > MAX_HISTORY) history.shift();
-            drawSparkline(data.symbol, history);
-
-            processUpdate(row, bidEl, data.bid);
-            processUpdate(row, askEl, data.ask);
-
-            const date = new Date(data.timestamp * 1000);
-            lastUpdateEl.textContent = date.toLocaleTimeString();
-
-            // Trigger strong visual heartbeat pulse every second
-            // This clearly communicates "refresh happened" to the user
-            row.classList.remove('pulse-neutral');
-            void row.offsetWidth; // Trigger reflow
-            row.classList.add('pulse-neutral');
-        }
+        // The server publishes one array of quotes per update interval
+        const payload = JSON.parse(event.data);
+        const quotes = Array.isArray(payload) ? payload : [payload];
+        quotes.forEach(handleQuote);
     } catch (err) {
         console.error('Error parsing WebSocket message:', err);
     }
 };
 
+function handleQuote(data) {
+    // Per-venue quotes are also published; the dashboard shows the consolidated BBO
+    if (data.venue) return;
+
+    const row = document.getElementById(data.symbol);
+
+    if (row) {
+        const bidEl = row.querySelector('.bid');
+        const askEl = row.querySelector('.ask');
+        const lastUpdateEl = row.querySelector('.last-update');
+
+        // Update sparkline data
+        const history = priceHistory[data.symbol];
+        const midPrice = (data.bid + data.ask) / 2;
+        history.push(midPrice);
+        if (history.length > MAX_HISTORY) history.shift();
+        drawSparkline(data.symbol, history);
+
+        processUpdate(row, bidEl, data.bid);
+        processUpdate(row, askEl, data.ask);
+
+        const date = new Date(data.timestamp * 1000);
+        lastUpdateEl.textContent = date.toLocaleTimeString();
+
+        // Trigger strong visual heartbeat pulse every second
+        // This clearly communicates "refresh happened" to the user
+        row.classList.remove('pulse-neutral');
+        void row.offsetWidth; // Trigger reflow
+        row.classList.add('pulse-neutral');
+    }
+}
+
 function processUpdate(row, el, newPrice) {
     const isBid = el.classList.contains('bid');
     const isAsk = el.classList.contains('ask');